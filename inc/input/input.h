@@ -0,0 +1,123 @@
+#ifndef JA_INPUT_H
+#define JA_INPUT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace ja {
+
+/**
+ * Keys that drive the simulation.
+ */
+enum class input_key : std::uint8_t {
+    forward, backward,
+    left, right,
+    up, down,
+};
+
+/**
+ * Input state of a single frame.
+ */
+struct input_frame {
+    /**
+     * Seconds since the start of the recording.
+     */
+    double time{};
+
+    /**
+     * Bit set of pressed keys, indexed by input_key.
+     */
+    std::uint8_t keys{};
+
+    /**
+     * Cursor movement since the previous frame.
+     */
+    glm::vec2 cursor_delta{};
+
+    [[nodiscard]] bool pressed(input_key key) const {
+        return keys & (1u << static_cast<unsigned int>(key));
+    }
+
+    void press(input_key key) {
+        keys |= static_cast<std::uint8_t>(1u << static_cast<unsigned int>(key));
+    }
+};
+
+/**
+ * Writes input frames to a compact binary file.
+ */
+struct input_recorder {
+    /**
+     * Open a file for recording.
+     *
+     * @param path File to write the recording to.
+     */
+    explicit input_recorder(const std::string& path);
+
+    /**
+     * Append a frame to the recording.
+     */
+    void record(const input_frame& frame);
+
+    /**
+     * Whether the file could be written to.
+     */
+    [[nodiscard]] explicit operator bool() const {
+        return static_cast<bool>(ofs_);
+    }
+private:
+    std::ofstream ofs_{};
+};
+
+/**
+ * Replays a recording with a fixed timestep, independent of wall-clock time.
+ */
+struct input_player {
+    /**
+     * Load a recording.
+     *
+     * @param path File that was written by an input_recorder.
+     * @param timestep Simulated seconds that pass per call to next().
+     */
+    explicit input_player(const std::string& path, double timestep = 1.0 / 60.0);
+
+    /**
+     * Obtain the input of the next simulation step.
+     *
+     * Keys are those of the latest recorded frame, cursor movement is summed
+     * over all recorded frames that fall within the step.
+     */
+    [[nodiscard]] input_frame next();
+
+    /**
+     * Whether all recorded frames have been replayed.
+     */
+    [[nodiscard]] bool done() const {
+        return cursor_ == frames_.size();
+    }
+
+    [[nodiscard]] double timestep() const { return timestep_; }
+    [[nodiscard]] std::size_t frame_count() const { return frames_.size(); }
+
+    /**
+     * Whether the recording could be loaded.
+     */
+    [[nodiscard]] explicit operator bool() const {
+        return loaded_;
+    }
+private:
+    std::vector<input_frame> frames_{};
+    std::size_t cursor_{};
+    std::uint8_t keys_{};
+    double time_{};
+    double timestep_{};
+    bool loaded_{};
+};
+
+}
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef JA_PROTOCOL_H
+#define JA_PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace ja {
+
+/**
+ * Messages between a server and its clients.
+ *
+ * Every message is a frame: the size of the rest as a varint, the type and
+ * its fields. Coordinates and blocks are zigzag encoded varints, see
+ * chunk_codec.
+ */
+enum class message_type : std::uint8_t {
+    // client to server
+
+    /**
+     * Block the client is at and its view radius in chunks.
+     */
+    view,
+
+    /**
+     * Position of a block and the block to place there.
+     */
+    set_block,
+
+    // server to client
+
+    /**
+     * Coordinates of a chunk and its blocks, compressed with compress_blocks.
+     */
+    chunk,
+
+    /**
+     * Coordinates of a chunk and the blocks that changed, see write_delta.
+     */
+    delta,
+
+    /**
+     * Coordinates of a chunk the client no longer receives updates for.
+     */
+    unload,
+
+    /**
+     * Number of the tick whose updates came before, and the server time at which they were sent in microseconds.
+     */
+    tick,
+};
+
+/**
+ * A block that changed, by its position within the storage order of its chunk.
+ */
+struct block_change {
+    std::uint32_t index{};
+    int block{};
+};
+
+/**
+ * The fields of a message, the ones its type doesn't have are left alone.
+ */
+struct message {
+    message_type type{};
+
+    /**
+     * Coordinates of a block or a chunk.
+     */
+    glm::ivec3 pos{};
+
+    /**
+     * View radius or block.
+     */
+    int value{};
+
+    std::uint64_t tick{};
+    std::uint64_t time_us{};
+
+    /**
+     * Compressed blocks or changes, pointing into the buffer the message was read from.
+     */
+    std::span<const std::uint8_t> data{};
+};
+
+enum class read_status {
+    complete,
+    partial,
+    invalid,
+};
+
+void write_view(std::vector<std::uint8_t>& out, glm::ivec3 block, int radius);
+void write_set_block(std::vector<std::uint8_t>& out, glm::ivec3 pos, int block);
+void write_chunk(std::vector<std::uint8_t>& out, glm::ivec3 chunk, std::span<const std::uint8_t> compressed);
+
+/**
+ * Append the changes of a chunk, sorted by index, as increments of the index and blocks.
+ */
+void write_delta(std::vector<std::uint8_t>& out, glm::ivec3 chunk, std::span<const block_change> changes);
+
+void write_unload(std::vector<std::uint8_t>& out, glm::ivec3 chunk);
+void write_tick(std::vector<std::uint8_t>& out, std::uint64_t tick, std::uint64_t time_us);
+
+/**
+ * Read the message at the front of some bytes, advancing past it if it was complete.
+ */
+read_status read_message(std::span<const std::uint8_t>& in, message& message);
+
+/**
+ * Decode the changes of a delta message, replacing the contents of the output.
+ *
+ * @return Whether the changes were valid.
+ */
+bool read_changes(std::span<const std::uint8_t> data, std::vector<block_change>& changes);
+
+}
+
+#endif
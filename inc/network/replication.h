@@ -0,0 +1,232 @@
+#ifndef JA_REPLICATION_H
+#define JA_REPLICATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+#include <network/protocol.h>
+#include <network/socket.h>
+#include <utility/thread_pool.h>
+#include <world/world.h>
+
+namespace ja {
+
+/**
+ * Largest view radius a client can ask for, in chunks.
+ */
+inline constexpr int max_view_radius{16};
+
+struct replication_stats {
+    std::size_t clients{};
+
+    /**
+     * Number of whole chunks and chunk deltas sent by the last publish, and the blocks that changed.
+     */
+    std::size_t chunks{};
+    std::size_t deltas{};
+    std::size_t changes{};
+
+    /**
+     * Bytes queued by the last publish, and sent since the start.
+     */
+    std::size_t bytes{};
+    std::uint64_t total_bytes{};
+
+    float publish_ms{};
+};
+
+/**
+ * Sends the chunks of a world to clients, and the blocks that change in them.
+ *
+ * Clients receive the chunks within their view radius, compressed, when
+ * they come into view or are created, and after that only the blocks that
+ * changed, batched per tick. The server keeps a snapshot of every chunk at
+ * the revision it was last sent at to find the blocks that changed, which
+ * only costs a copy of the chunks that are written to in between.
+ */
+struct replication_server {
+    explicit replication_server(socket_handle listener)
+        :listener_{std::move(listener)} {}
+
+    /**
+     * Accept new clients and handle the messages of connected ones.
+     *
+     * Blocks placed by clients are placed in the world right away. Clients
+     * that send anything else than views and known blocks are disconnected.
+     */
+    void receive(world& world);
+
+    /**
+     * Send the updates of a tick to every client.
+     */
+    void publish(const world& world, thread_pool& pool, std::uint64_t tick);
+
+    /**
+     * Send bytes that didn't fit into the sockets before.
+     *
+     * @return Whether bytes are still waiting to be sent.
+     */
+    bool flush();
+
+    [[nodiscard]] std::size_t client_count() const { return clients_.size(); }
+    [[nodiscard]] const replication_stats& stats() const { return stats_; }
+private:
+    struct client {
+        socket_handle socket;
+        std::vector<std::uint8_t> in{};
+        std::vector<std::uint8_t> out{};
+
+        /**
+         * Number of bytes at the front of out that were sent.
+         */
+        std::size_t sent{};
+
+        glm::ivec3 view{};
+        int radius{-1};
+        bool view_changed{};
+        bool closed{};
+
+        std::unordered_set<glm::ivec3, ivec3_hash> subscribed{};
+
+        /**
+         * Chunks that came into and went out of view in this tick.
+         */
+        std::vector<glm::ivec3> added{};
+        std::vector<glm::ivec3> removed{};
+
+        /**
+         * Number of deltas and bytes queued by the last publish.
+         */
+        std::size_t deltas{};
+        std::size_t queued{};
+    };
+
+    struct replicated_chunk {
+        chunk_snapshot snapshot{};
+
+        /**
+         * The message with the whole chunk at the revision of the snapshot, made when someone needs it.
+         */
+        std::vector<std::uint8_t> full{};
+
+        /**
+         * The message with the changes of this tick, empty if there were none.
+         */
+        std::vector<std::uint8_t> delta{};
+        std::size_t changes{};
+
+        std::size_t subscribers{};
+    };
+
+    /**
+     * Find the chunks that came into and went out of view of a client.
+     */
+    void update_interest(const world& world, client& client);
+
+    /**
+     * Forget the clients whose connection failed or that misbehaved.
+     */
+    void drop_closed();
+
+    socket_handle listener_;
+    std::vector<client> clients_{};
+    std::unordered_map<glm::ivec3, replicated_chunk, ivec3_hash> chunks_{};
+    std::optional<std::size_t> tracker_{};
+    std::vector<glm::ivec3> world_changes_{};
+    replication_stats stats_{};
+
+    std::vector<std::pair<glm::ivec3, replicated_chunk*>> changed_{};
+    std::vector<chunk_snapshot> previous_{};
+    std::vector<std::pair<glm::ivec3, replicated_chunk*>> missing_{};
+    std::vector<glm::ivec3> wanted_{};
+};
+
+struct replication_client_stats {
+    /**
+     * Number of ticks received, and the latest one.
+     */
+    std::uint64_t ticks{};
+    std::uint64_t last_tick{};
+
+    std::uint64_t bytes{};
+    std::uint64_t chunks{};
+    std::uint64_t deltas{};
+    std::uint64_t changes{};
+    std::uint64_t unloads{};
+
+    /**
+     * Time from sending the updates of a tick until they were applied, which
+     * needs the server to run on the same machine to mean anything.
+     */
+    float latency_ms{};
+    float total_latency_ms{};
+    float max_latency_ms{};
+};
+
+/**
+ * Receives chunks from a replication_server and applies them to a world.
+ *
+ * The world is only written through here, and its revisions tell which
+ * chunks need a new mesh as usual. Chunks can't be removed from a world, so
+ * the ones that went out of view are emptied instead.
+ */
+struct replication_client {
+    explicit replication_client(socket_handle socket)
+        :socket_{std::move(socket)} {}
+
+    /**
+     * Ask for the chunks around a block, which only goes out if the chunk of the block or the radius changed.
+     */
+    void set_view(glm::ivec3 block, int radius);
+
+    /**
+     * Ask the server to place a block.
+     */
+    void set_block(glm::ivec3 pos, int block);
+
+    /**
+     * Send the messages asked for and apply the updates that arrived.
+     *
+     * Without a world the updates are only decoded, so load generators
+     * don't need to keep a copy of the world for every client.
+     *
+     * @return Whether the connection is still open and the server behaves.
+     */
+    bool update(world* world);
+
+    /**
+     * Obtain the chunks within view, as far as the updates received so far go.
+     */
+    [[nodiscard]] const std::unordered_set<glm::ivec3, ivec3_hash>& loaded() const { return loaded_; }
+
+    [[nodiscard]] const socket_handle& socket() const { return socket_; }
+    [[nodiscard]] const replication_client_stats& stats() const { return stats_; }
+private:
+    bool apply(world* world, const message& message);
+
+    socket_handle socket_;
+    std::vector<std::uint8_t> in_{};
+    std::vector<std::uint8_t> out_{};
+    std::size_t sent_{};
+
+    glm::ivec3 view_{};
+    int radius_{-1};
+
+    std::unordered_set<glm::ivec3, ivec3_hash> loaded_{};
+    std::vector<block_change> changes_{};
+    replication_client_stats stats_{};
+};
+
+/**
+ * Obtain the time messages are stamped with, in microseconds.
+ */
+[[nodiscard]] std::uint64_t replication_time_us();
+
+}
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef JA_SOCKET_H
+#define JA_SOCKET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+#include <utility/unique_resource.h>
+
+namespace ja {
+
+/**
+ * A functor for closing sockets.
+ */
+struct socket_deleter {
+    void operator()(int socket) const;
+};
+
+/**
+ * A non-blocking socket, 0 if it was moved from.
+ */
+using socket_handle = unique_resource<int, socket_deleter>;
+
+/*
+ * Addresses are either "unix:<path>" for a Unix domain socket, or
+ * "<IPv4 address>:<port>" for TCP. Functions that fail leave the reason in
+ * errno.
+ */
+
+/**
+ * Listen for connections on an address, replacing a Unix domain socket left behind by an earlier run.
+ */
+[[nodiscard]] std::optional<socket_handle> listen_on(std::string_view address);
+
+/**
+ * Connect to an address, waiting until the connection is established.
+ */
+[[nodiscard]] std::optional<socket_handle> connect_to(std::string_view address);
+
+/**
+ * Accept a pending connection, if there is one.
+ */
+[[nodiscard]] std::optional<socket_handle> accept_connection(const socket_handle& listener);
+
+/**
+ * Send as many bytes as the socket takes without waiting.
+ *
+ * @return Number of bytes sent, or nothing if the connection failed.
+ */
+[[nodiscard]] std::optional<std::size_t> send_some(const socket_handle& socket, std::span<const std::uint8_t> bytes);
+
+/**
+ * Append the bytes that arrived on a socket to a buffer, without waiting.
+ *
+ * @return Whether the connection is still open.
+ */
+bool receive_some(const socket_handle& socket, std::vector<std::uint8_t>& buffer);
+
+/**
+ * Wait until some of the sockets can be read, or the timeout passes.
+ */
+void wait_readable(std::span<const socket_handle* const> sockets, int timeout_ms);
+
+}
+
+#endif
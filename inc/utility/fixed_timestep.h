@@ -0,0 +1,45 @@
+#ifndef JA_FIXED_TIMESTEP_H
+#define JA_FIXED_TIMESTEP_H
+
+#include <algorithm>
+
+namespace ja {
+
+/**
+ * Turns variable frame times into a whole number of fixed simulation steps.
+ */
+struct fixed_timestep {
+    /**
+     * @param step Seconds per simulation step.
+     * @param max_steps Maximum number of steps per frame, so a slow frame can't snowball.
+     */
+    explicit fixed_timestep(double step, int max_steps = 8)
+        :step_{step}, max_steps_{max_steps} {}
+
+    /**
+     * Let time pass and obtain the number of steps to simulate.
+     */
+    [[nodiscard]] int advance(double elapsed) {
+        accumulator_ += elapsed;
+        const int steps = std::min(static_cast<int>(accumulator_ / step_), max_steps_);
+        accumulator_ = std::min(accumulator_ - steps * step_, step_);
+        return steps;
+    }
+
+    /**
+     * Obtain how far the time is between the last and the next step, in [0, 1].
+     */
+    [[nodiscard]] double alpha() const {
+        return accumulator_ / step_;
+    }
+
+    [[nodiscard]] double step() const { return step_; }
+private:
+    double step_{};
+    double accumulator_{};
+    int max_steps_{};
+};
+
+}
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef JA_SCRATCH_ARENA_H
+#define JA_SCRATCH_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace ja {
+
+/**
+ * A bump allocator for short-lived, trivial data.
+ *
+ * Memory is handed out from a buffer that is reused after every reset. When
+ * the buffer runs out, another one is allocated and on the next reset they
+ * are merged into a single buffer of the combined size. That way the arena
+ * grows to the high-water mark of its use, after which it no longer
+ * allocates from the heap at all.
+ */
+struct scratch_arena {
+    /**
+     * Allocate uninitialized storage for a number of objects.
+     *
+     * The storage stays valid until the next reset.
+     */
+    template<typename T>
+    requires std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>
+    [[nodiscard]] std::span<T> allocate(std::size_t count) {
+        static_assert(alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+        auto* data = allocate_bytes(count * sizeof(T), alignof(T));
+        return std::span{reinterpret_cast<T*>(data), count};
+    }
+
+    /**
+     * Release all allocations at once.
+     */
+    void reset();
+
+    /**
+     * Obtain the number of bytes that are allocated since the last reset.
+     */
+    [[nodiscard]] std::size_t used() const { return used_; }
+
+    /**
+     * Obtain the number of bytes the arena holds on to.
+     */
+    [[nodiscard]] std::size_t capacity() const;
+
+    /**
+     * Obtain how often the arena allocated from the heap.
+     */
+    [[nodiscard]] std::size_t heap_allocations() const { return heap_allocations_; }
+private:
+    struct buffer {
+        std::unique_ptr<std::byte[]> data{};
+        std::size_t size{};
+    };
+
+    [[nodiscard]] std::byte* allocate_bytes(std::size_t size, std::size_t alignment);
+
+    void add_buffer(std::size_t size);
+
+    static constexpr std::size_t min_buffer_size{64 * 1024};
+
+    std::vector<buffer> buffers_{};
+    std::size_t offset_{};
+    std::size_t used_{};
+    std::size_t heap_allocations_{};
+};
+
+}
+
+#endif
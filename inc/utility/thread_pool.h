@@ -0,0 +1,87 @@
+#ifndef JA_THREAD_POOL_H
+#define JA_THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <latch>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace ja {
+
+/**
+ * A fixed set of worker threads that execute submitted tasks.
+ */
+struct thread_pool {
+    /**
+     * Start the worker threads.
+     *
+     * @param thread_count Number of workers, at least one is started.
+     */
+    explicit thread_pool(std::size_t thread_count = std::thread::hardware_concurrency());
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    /**
+     * Finish all pending tasks and join the workers.
+     */
+    ~thread_pool();
+
+    /**
+     * Queue a task for execution on one of the workers.
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * Invoke a callable for every index in [0, count) and wait for completion.
+     *
+     * Must not be called from one of the workers.
+     */
+    template<std::invocable<std::size_t> F>
+    void parallel_for(std::size_t count, F&& f);
+
+    /**
+     * Obtain the index of the calling worker, or size() if called from any other thread.
+     */
+    [[nodiscard]] std::size_t current_worker() const;
+
+    [[nodiscard]] std::size_t size() const { return workers_.size(); }
+private:
+    void work(std::stop_token token, std::size_t index);
+
+    std::mutex mutex_{};
+    std::condition_variable_any condition_{};
+    std::queue<std::function<void()>> tasks_{};
+    std::vector<std::jthread> workers_{};
+};
+
+template<std::invocable<std::size_t> F>
+void thread_pool::parallel_for(std::size_t count, F&& f) {
+    if (count == 0) return;
+
+    const auto task_count = std::min(count, size());
+    std::atomic<std::size_t> next{};
+    std::latch done{static_cast<std::ptrdiff_t>(task_count)};
+
+    for (std::size_t task = 0; task < task_count; ++task) {
+        submit([&] {
+            for (auto i = next++; i < count; i = next++) {
+                std::invoke(f, i);
+            }
+            done.count_down();
+        });
+    }
+
+    done.wait();
+}
+
+}
+
+#endif
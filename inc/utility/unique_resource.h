@@ -44,7 +44,7 @@ struct unique_resource {
      */
     void swap(unique_resource& other) noexcept {
         std::swap(resource_, other.resource_);
-        std::swap(resource_, other.deleter_);
+        std::swap(deleter_, other.deleter_);
     }
 
     /**
@@ -0,0 +1,42 @@
+#ifndef JA_AABB_H
+#define JA_AABB_H
+
+#include <glm/glm.hpp>
+
+namespace ja {
+
+/**
+ * An axis-aligned bounding box.
+ */
+struct aabb {
+    glm::vec3 min{};
+    glm::vec3 max{};
+
+    [[nodiscard]] glm::vec3 center() const {
+        return (min + max) * 0.5f;
+    }
+
+    [[nodiscard]] glm::vec3 size() const {
+        return max - min;
+    }
+
+    /**
+     * Whether two boxes overlap, touching boxes don't.
+     */
+    [[nodiscard]] bool intersects(const aabb& other) const {
+        return min.x < other.max.x && max.x > other.min.x
+            && min.y < other.max.y && max.y > other.min.y
+            && min.z < other.max.z && max.z > other.min.z;
+    }
+
+    /**
+     * Obtain the box moved by an offset.
+     */
+    [[nodiscard]] aabb translated(glm::vec3 offset) const {
+        return aabb{min + offset, max + offset};
+    }
+};
+
+}
+
+#endif
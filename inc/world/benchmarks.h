@@ -0,0 +1,53 @@
+#ifndef JA_BENCHMARKS_H
+#define JA_BENCHMARKS_H
+
+#include <world/world.h>
+
+namespace ja {
+
+/**
+ * Compare dense chunks with brick maps for the chunks of a world, grouped by
+ * how full they are: memory, raycasts, meshing, and meshing at a lower level
+ * of detail.
+ */
+void report_storage(const world& world);
+
+/**
+ * Compare saving and loading random edits through an edit journal with doing so for every chunk they touched.
+ */
+void run_journal_benchmark();
+
+/**
+ * Time region edits of a 512^3 box, compared to placing blocks one at a time.
+ */
+void run_edit_benchmark();
+
+/**
+ * Time block ticks on 100x100 chunks with grass and clocks above as many
+ * chunks with nothing to tick, and check that ticks don't depend on the
+ * number of threads.
+ */
+void run_tick_benchmark();
+
+/**
+ * Time fluid flowing from sources scattered over generated terrain until it comes to rest.
+ */
+void run_fluid_benchmark();
+
+/**
+ * Time paths between random cells on the surface of generated terrain, before and after digging a canyon through it.
+ */
+void run_nav_benchmark();
+
+/**
+ * Keep writing to a few chunks while other threads hold and read snapshots
+ * of them, and check that every snapshot still shows the blocks it was
+ * taken at. Meant to be run under ThreadSanitizer, see the README.
+ *
+ * @return Whether every snapshot was intact.
+ */
+bool run_snapshot_stress();
+
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef JA_BLOCK_H
+#define JA_BLOCK_H
+
+namespace ja::blocks {
+
+/**
+ * Block ids, which double as layers of the texture atlas.
+ */
+inline constexpr int empty{-1};
+inline constexpr int grass{0};
+inline constexpr int dirt{1};
+inline constexpr int orange{5};
+inline constexpr int brick{6};
+
+/**
+ * Layers of the texture atlas that aren't placed as blocks.
+ */
+inline constexpr int water{21};
+
+/**
+ * Number of layers of the texture atlas, so every block id is below it.
+ */
+inline constexpr int atlas_layers{25};
+
+}
+
+namespace ja {
+
+/**
+ * Whether a block id denotes the absence of a block.
+ */
+[[nodiscard]] constexpr bool is_empty(int block) {
+    return block < 0;
+}
+
+/**
+ * Whether a block id is empty or one of the blocks that can be placed, such as to check ids from elsewhere.
+ */
+[[nodiscard]] constexpr bool is_known_block(int block) {
+    return block == blocks::empty || block == blocks::grass || block == blocks::dirt || block == blocks::orange || block == blocks::brick;
+}
+
+}
+
+#endif
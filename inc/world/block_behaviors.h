@@ -0,0 +1,16 @@
+#ifndef JA_BLOCK_BEHAVIORS_H
+#define JA_BLOCK_BEHAVIORS_H
+
+#include <world/tick_scheduler.h>
+
+namespace ja {
+
+/**
+ * Let grass spread onto nearby dirt that has nothing on top, and turn back
+ * into dirt when covered.
+ */
+void add_grass_spread(tick_scheduler& scheduler);
+
+}
+
+#endif
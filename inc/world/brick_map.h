@@ -0,0 +1,210 @@
+#ifndef JA_BRICK_MAP_H
+#define JA_BRICK_MAP_H
+
+#include <cstddef>
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <ranges>
+#include <world/block.h>
+#include <world/chunk.h>
+
+namespace ja {
+
+/**
+ * Sparse storage for the blocks of a chunk.
+ *
+ * Blocks are grouped in bricks of 8 x 8 x 8. A brick in which every block
+ * is the same stores just that block, other bricks point to dense storage.
+ * Regions of sky or solid ground take next to no memory that way, and code
+ * that walks the blocks can skip over uniform bricks as a whole.
+ */
+template<std::size_t Width, std::size_t Height, std::size_t Depth>
+struct brick_map {
+    static constexpr std::size_t brick_size{8};
+    static constexpr std::size_t brick_volume{brick_size * brick_size * brick_size};
+
+    static_assert(Width % brick_size == 0 && Height % brick_size == 0 && Depth % brick_size == 0);
+
+    static constexpr std::size_t width{Width};
+    static constexpr std::size_t height{Height};
+    static constexpr std::size_t depth{Depth};
+    static constexpr std::size_t volume{Width * Height * Depth};
+
+    static constexpr std::size_t bricks_x{Width / brick_size};
+    static constexpr std::size_t bricks_y{Height / brick_size};
+    static constexpr std::size_t bricks_z{Depth / brick_size};
+
+    brick_map() = default;
+
+    /**
+     * Convert dense storage into bricks.
+     */
+    explicit brick_map(const chunk<Width, Height, Depth>& chunk);
+
+    /**
+     * Obtain the block at some coordinates.
+     */
+    [[nodiscard]] int operator[](std::size_t i, std::size_t j, std::size_t k) const {
+        const auto& brick = bricks_[brick_index(i / brick_size, j / brick_size, k / brick_size)];
+        if (!brick.dense) return brick.uniform;
+        return (*brick.dense)[local_index(i % brick_size, j % brick_size, k % brick_size)];
+    }
+
+    /**
+     * Place a block, giving its brick dense storage if needed.
+     */
+    void set(std::size_t i, std::size_t j, std::size_t k, int block);
+
+    /**
+     * Drop the dense storage of bricks that turned out to be uniform.
+     */
+    void compact();
+
+    /**
+     * Whether all blocks of a brick are the same.
+     *
+     * Bricks with dense storage count as not uniform, even if they are, until compacted.
+     */
+    [[nodiscard]] bool uniform(std::size_t bx, std::size_t by, std::size_t bz) const {
+        return !bricks_[brick_index(bx, by, bz)].dense;
+    }
+
+    /**
+     * Obtain the block that fills a uniform brick.
+     */
+    [[nodiscard]] int uniform_block(std::size_t bx, std::size_t by, std::size_t bz) const {
+        return bricks_[brick_index(bx, by, bz)].uniform;
+    }
+
+    /**
+     * Obtain the number of solid blocks.
+     */
+    [[nodiscard]] std::size_t solid_count() const;
+
+    /**
+     * Obtain the number of bytes used, including dense storage.
+     */
+    [[nodiscard]] std::size_t memory_bytes() const;
+
+    /**
+     * Convert the bricks back into dense storage.
+     */
+    [[nodiscard]] chunk<Width, Height, Depth> to_chunk() const;
+
+    /**
+     * Obtain a coarser version of the blocks, for distant levels of detail.
+     *
+     * Every cell of the result holds a solid block of its Factor^3 region, if there is one.
+     */
+    template<std::size_t Factor>
+    [[nodiscard]] chunk<Width / Factor, Height / Factor, Depth / Factor> downsample() const;
+private:
+    using dense_brick = std::array<int, brick_volume>;
+
+    struct brick {
+        int uniform{blocks::empty};
+        std::unique_ptr<dense_brick> dense{};
+    };
+
+    [[nodiscard]] static constexpr std::size_t brick_index(std::size_t bx, std::size_t by, std::size_t bz) {
+        return (bx * bricks_y + by) * bricks_z + bz;
+    }
+
+    [[nodiscard]] static constexpr std::size_t local_index(std::size_t x, std::size_t y, std::size_t z) {
+        return (x * brick_size + y) * brick_size + z;
+    }
+
+    std::array<brick, bricks_x * bricks_y * bricks_z> bricks_{};
+};
+
+template<std::size_t Width, std::size_t Height, std::size_t Depth>
+brick_map<Width, Height, Depth>::brick_map(const chunk<Width, Height, Depth>& chunk) {
+    for (auto [i, j, k] : chunk.indices()) {
+        set(i, j, k, chunk[i, j, k]);
+    }
+    compact();
+}
+
+template<std::size_t Width, std::size_t Height, std::size_t Depth>
+void brick_map<Width, Height, Depth>::set(std::size_t i, std::size_t j, std::size_t k, int block) {
+    auto& brick = bricks_[brick_index(i / brick_size, j / brick_size, k / brick_size)];
+    if (!brick.dense) {
+        if (brick.uniform == block) return;
+        brick.dense = std::make_unique<dense_brick>();
+        brick.dense->fill(brick.uniform);
+    }
+    (*brick.dense)[local_index(i % brick_size, j % brick_size, k % brick_size)] = block;
+}
+
+template<std::size_t Width, std::size_t Height, std::size_t Depth>
+void brick_map<Width, Height, Depth>::compact() {
+    for (auto& brick : bricks_) {
+        if (!brick.dense) continue;
+
+        const int first = brick.dense->front();
+        if (std::ranges::all_of(*brick.dense, [first](int block) { return block == first; })) {
+            brick.uniform = first;
+            brick.dense.reset();
+        }
+    }
+}
+
+template<std::size_t Width, std::size_t Height, std::size_t Depth>
+std::size_t brick_map<Width, Height, Depth>::solid_count() const {
+    std::size_t count{};
+    for (const auto& brick : bricks_) {
+        if (brick.dense) {
+            count += static_cast<std::size_t>(std::ranges::count_if(*brick.dense, [](int block) { return !is_empty(block); }));
+        } else if (!is_empty(brick.uniform)) {
+            count += brick_volume;
+        }
+    }
+    return count;
+}
+
+template<std::size_t Width, std::size_t Height, std::size_t Depth>
+std::size_t brick_map<Width, Height, Depth>::memory_bytes() const {
+    const auto dense = std::ranges::count_if(bricks_, [](const brick& brick) { return brick.dense != nullptr; });
+    return sizeof(*this) + static_cast<std::size_t>(dense) * sizeof(dense_brick);
+}
+
+template<std::size_t Width, std::size_t Height, std::size_t Depth>
+chunk<Width, Height, Depth> brick_map<Width, Height, Depth>::to_chunk() const {
+    chunk<Width, Height, Depth> result{};
+    for (auto [i, j, k] : result.indices()) {
+        result[i, j, k] = (*this)[i, j, k];
+    }
+    return result;
+}
+
+template<std::size_t Width, std::size_t Height, std::size_t Depth>
+template<std::size_t Factor>
+chunk<Width / Factor, Height / Factor, Depth / Factor> brick_map<Width, Height, Depth>::downsample() const {
+    // every cell then lies within a single brick
+    static_assert(brick_size % Factor == 0);
+
+    chunk<Width / Factor, Height / Factor, Depth / Factor> result{};
+
+    for (auto [i, j, k] : result.indices()) {
+        const auto& brick = bricks_[brick_index(i * Factor / brick_size, j * Factor / brick_size, k * Factor / brick_size)];
+        if (!brick.dense) {
+            result[i, j, k] = brick.uniform;
+            continue;
+        }
+
+        for (auto [x, y, z] : std::views::cartesian_product(std::views::iota(0uz, Factor), std::views::iota(0uz, Factor), std::views::iota(0uz, Factor))) {
+            const int block = (*this)[i * Factor + x, j * Factor + y, k * Factor + z];
+            if (!is_empty(block)) {
+                result[i, j, k] = block;
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+}
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef JA_CHUNK_CODEC_H
+#define JA_CHUNK_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <ranges>
+#include <span>
+#include <vector>
+
+namespace ja {
+
+/**
+ * Append an unsigned integer using 7 bits per byte, least significant first.
+ */
+void write_varint(std::vector<std::uint8_t>& out, std::uint64_t value);
+
+/**
+ * Read an integer written by write_varint, advancing the input past it.
+ *
+ * Truncated input results in 0 and an empty input.
+ */
+[[nodiscard]] std::uint64_t read_varint(std::span<const std::uint8_t>& in);
+
+/**
+ * Map signed integers to unsigned ones so that small magnitudes stay small.
+ */
+[[nodiscard]] constexpr std::uint64_t zigzag_encode(std::int64_t value) {
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+[[nodiscard]] constexpr std::int64_t zigzag_decode(std::uint64_t value) {
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+/**
+ * Compress bytes with a fast LZ77 style codec, appending to the output.
+ *
+ * The output is a list of sequences of literals followed by a match of at
+ * least 4 bytes within the previous 64 KiB, like LZ4 but without framing.
+ */
+void lz_compress(std::span<const std::uint8_t> in, std::vector<std::uint8_t>& out);
+
+/**
+ * Decompress bytes produced by lz_compress, replacing the contents of the output.
+ *
+ * @return Whether the input was valid.
+ */
+bool lz_decompress(std::span<const std::uint8_t> in, std::vector<std::uint8_t>& out);
+
+/**
+ * Compress a range of block ids.
+ *
+ * Runs of equal blocks are encoded first, which turns the large uniform
+ * regions of terrain into a few bytes, then the runs are compressed with
+ * lz_compress to catch rows that repeat.
+ */
+template<std::ranges::input_range R>
+[[nodiscard]] std::vector<std::uint8_t> compress_blocks(R&& blocks) {
+    std::vector<std::uint8_t> runs{};
+
+    auto emit = [&runs](std::uint64_t length, int block) {
+        write_varint(runs, length);
+        write_varint(runs, zigzag_encode(block));
+    };
+
+    std::uint64_t length{};
+    int previous{};
+    for (int block : blocks) {
+        if (length > 0 && block != previous) {
+            emit(length, previous);
+            length = 0;
+        }
+        previous = block;
+        ++length;
+    }
+    if (length > 0) emit(length, previous);
+
+    std::vector<std::uint8_t> out{};
+    write_varint(out, runs.size());
+    lz_compress(runs, out);
+    return out;
+}
+
+/**
+ * Decompress block ids produced by compress_blocks into a range of the same size.
+ *
+ * @return Whether the input was valid and filled the range exactly.
+ */
+template<std::ranges::input_range R>
+bool decompress_blocks(std::span<const std::uint8_t> in, R&& blocks) {
+    thread_local std::vector<std::uint8_t> runs{};
+
+    const auto size = read_varint(in);
+    if (!lz_decompress(in, runs) || runs.size() != size) return false;
+
+    std::span<const std::uint8_t> remaining{runs};
+    auto it = std::ranges::begin(blocks);
+    const auto end = std::ranges::end(blocks);
+
+    while (!remaining.empty()) {
+        auto length = read_varint(remaining);
+        const auto block = static_cast<int>(zigzag_decode(read_varint(remaining)));
+
+        for (; length > 0; --length, ++it) {
+            if (it == end) return false;
+            *it = block;
+        }
+    }
+
+    return it == end;
+}
+
+}
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef JA_CHUNK_COMPRESSOR_H
+#define JA_CHUNK_COMPRESSOR_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <glm/glm.hpp>
+#include <world/world.h>
+
+namespace ja {
+
+struct compression_stats {
+    /**
+     * Number of chunks currently held in compressed form.
+     */
+    std::size_t compressed{};
+
+    /**
+     * Number of chunks waiting to be compressed.
+     */
+    std::size_t pending{};
+
+    /**
+     * Size of the compressed chunks, compared to their size uncompressed.
+     */
+    std::size_t compressed_bytes{};
+    std::size_t raw_bytes{};
+
+    /**
+     * Total time spent compressing on the background thread.
+     */
+    float compress_ms{};
+};
+
+/**
+ * Compresses the chunks of a world that haven't been used for a while.
+ *
+ * Chunks that weren't accessed through the world or reported as active
+ * for some time are compressed from a snapshot on a background thread,
+ * after which the world drops their blocks. The world decompresses them
+ * again on the next access.
+ */
+struct chunk_compressor {
+    /**
+     * Start the background thread.
+     *
+     * @param idle_seconds Time a chunk has to be unused before it's compressed.
+     */
+    explicit chunk_compressor(double idle_seconds = 10.0);
+
+    chunk_compressor(const chunk_compressor&) = delete;
+    chunk_compressor& operator=(const chunk_compressor&) = delete;
+
+    /**
+     * Hand idle chunks to the background thread and store the ones it finished.
+     *
+     * Must be called from the thread that edits the world.
+     *
+     * @param active Chunks that are in use without accessing the world, such as rendered chunks.
+     */
+    void update(world& world, double now, std::span<const glm::ivec3> active);
+
+    [[nodiscard]] compression_stats stats() const;
+private:
+    struct job {
+        glm::ivec3 coord{};
+        chunk_snapshot snapshot{};
+    };
+
+    struct result {
+        glm::ivec3 coord{};
+        std::uint64_t revision{};
+        std::vector<std::uint8_t> data{};
+    };
+
+    void work(std::stop_token token);
+
+    double idle_seconds_{};
+    std::unordered_map<glm::ivec3, double, ivec3_hash> last_used_{};
+    std::unordered_set<glm::ivec3, ivec3_hash> pending_{};
+    compression_stats stats_{};
+
+    std::mutex mutex_{};
+    std::condition_variable_any condition_{};
+    std::deque<job> jobs_{};
+    std::vector<result> results_{};
+    float compress_ms_{};
+
+    std::jthread worker_{};
+};
+
+}
+
+#endif
@@ -0,0 +1,213 @@
+#ifndef JA_CHUNK_MESH_H
+#define JA_CHUNK_MESH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <ranges>
+#include <span>
+#include <vector>
+#include <glad/gl.h>
+#include <graphics/buffer.h>
+#include <graphics/vertex_array.h>
+#include <utility/scratch_arena.h>
+#include <utility/thread_pool.h>
+#include <world/chunk.h>
+#include <world/cube.h>
+#include <world/face_mesh.h>
+
+namespace ja {
+
+/**
+ * Vertices and indices of a chunk, allocated from a scratch arena.
+ */
+struct mesh_data {
+    std::span<cube_vertex> vertices{};
+    std::span<unsigned int> indices{};
+};
+
+/**
+ * Generate a triangle mesh of the visible faces of the blocks of a chunk.
+ *
+ * The visible faces are counted in a first pass, so the output is a single
+ * allocation that fits them exactly.
+ */
+template<std::size_t Width, std::size_t Height, std::size_t Depth>
+[[nodiscard]] mesh_data make_chunk_mesh(const chunk<Width, Height, Depth>& chunk, scratch_arena& arena);
+
+/**
+ * The GPU side of a chunk: an indexed triangle mesh of the visible faces of its blocks.
+ */
+struct chunk_mesh {
+    /**
+     * Regenerate the mesh from the blocks of a chunk.
+     */
+    template<std::size_t Width, std::size_t Height, std::size_t Depth>
+    void rebuild(const chunk<Width, Height, Depth>& chunk);
+
+    /**
+     * Replace the mesh with previously generated data.
+     */
+    void upload(const mesh_data& data);
+
+    /**
+     * Replace only the indices, such as to draw the same faces in another order.
+     */
+    void upload_indices(std::span<const unsigned int> indices);
+
+    [[nodiscard]] GLuint vertex_array() const { return vao_.get(); }
+    [[nodiscard]] std::size_t index_count() const { return index_count_; }
+    [[nodiscard]] std::size_t geometry_bytes() const { return geometry_bytes_; }
+private:
+    vertex_array_handle vao_{make_vertex_array()};
+    buffer_handle vbo_{make_buffer()};
+    buffer_handle ebo_{make_buffer()};
+    std::size_t index_count_{};
+    std::size_t geometry_bytes_{};
+};
+
+struct mesher_stats {
+    std::size_t meshed{};
+    std::size_t batches{};
+
+    /**
+     * Heap allocations of the scratch arenas in total and in the last batch,
+     * and the last batch that allocated at all, counting from 1.
+     */
+    std::size_t heap_allocations{};
+    std::size_t batch_heap_allocations{};
+    std::size_t last_allocating_batch{};
+
+    std::size_t scratch_bytes{};
+};
+
+/**
+ * Meshes batches of chunks on a thread pool.
+ *
+ * Every worker has its own scratch arena, so once the arenas have grown to
+ * fit the largest batch, meshing doesn't allocate anymore.
+ */
+struct chunk_mesher {
+    /**
+     * Create an arena for each worker of the pool that batches are meshed on.
+     */
+    explicit chunk_mesher(const thread_pool& pool)
+        :arenas_(pool.size()) {}
+
+    /**
+     * Mesh a batch of chunks.
+     *
+     * @param pool The pool the mesher was created for, only its workers mesh chunks.
+     * @param meshes Receives the mesh of every chunk, which stays valid until the next call.
+     */
+    template<std::size_t Width, std::size_t Height, std::size_t Depth>
+    void mesh(thread_pool& pool, std::span<const chunk<Width, Height, Depth>* const> chunks, std::span<mesh_data> meshes);
+
+    /**
+     * Collect the packed faces of a batch of chunks, see make_chunk_faces().
+     *
+     * @param pool The pool the mesher was created for.
+     * @param faces Receives the faces of every chunk, which stay valid until the next call.
+     */
+    template<std::size_t Width, std::size_t Height, std::size_t Depth>
+    void mesh_faces(thread_pool& pool, std::span<const chunk<Width, Height, Depth>* const> chunks, std::span<std::span<std::uint32_t>> faces);
+
+    [[nodiscard]] mesher_stats stats() const;
+private:
+    void begin_batch();
+    void end_batch(std::size_t count);
+
+    [[nodiscard]] std::size_t heap_allocations() const;
+
+    std::vector<scratch_arena> arenas_{};
+    std::size_t meshed_{};
+    std::size_t batches_{};
+    std::size_t batch_start_allocations_{};
+    std::size_t batch_heap_allocations_{};
+    std::size_t last_allocating_batch_{};
+};
+
+template<std::size_t Width, std::size_t Height, std::size_t Depth>
+mesh_data make_chunk_mesh(const chunk<Width, Height, Depth>& chunk, scratch_arena& arena) {
+    using vertex_type = cube_vertex;
+    using index_type = unsigned int;
+
+    // faces between two blocks of the chunk are never visible
+    auto hidden = [&chunk](glm::ivec3 neighbor) {
+        if (glm::any(glm::lessThan(neighbor, glm::ivec3{0}))) return false;
+        if (glm::any(glm::greaterThanEqual(neighbor, glm::ivec3{Width, Height, Depth}))) return false;
+        return !is_empty(chunk[neighbor.x, neighbor.y, neighbor.z]);
+    };
+
+    // count the visible faces first, as sizing for every face of every solid
+    // block would grow the arenas to megabytes per chunk
+    std::size_t face_count{};
+    for (auto [index, block] : std::views::zip(chunk.indices(), chunk.blocks())) {
+        if (is_empty(block)) continue;
+        auto [i, j, k] = index;
+        face_count += static_cast<std::size_t>(std::ranges::count_if(cube_faces, [&](cube_face face) {
+            return !hidden(glm::ivec3{i, j, k} + cube_face_normal(face));
+        }));
+    }
+
+    auto vertices = arena.allocate<vertex_type>(face_count * 4);
+    auto indices = arena.allocate<index_type>(face_count * cube_face_indices.size());
+
+    std::size_t vertex_count{};
+    std::size_t index_count{};
+
+    for (auto [index, block] : std::views::zip(chunk.indices(), chunk.blocks())) {
+        if (is_empty(block)) continue;
+        auto [i, j, k] = index;
+
+        for (auto face : cube_faces) {
+            if (hidden(glm::ivec3{i, j, k} + cube_face_normal(face))) continue;
+
+            const auto offset = static_cast<index_type>(vertex_count);
+
+            std::ranges::transform(cube_face_vertices(face), vertices.begin() + vertex_count, [block, i, j, k](vertex_type vertex) {
+                vertex.position += glm::vec3{i, j, k};
+                vertex.texcoord.z = block;
+                return vertex;
+            });
+            vertex_count += cube_face_vertices(face).size();
+
+            std::ranges::transform(cube_face_indices, indices.begin() + index_count, [offset](index_type index) {
+                return index + offset;
+            });
+            index_count += cube_face_indices.size();
+        }
+    }
+
+    return mesh_data{vertices.first(vertex_count), indices.first(index_count)};
+}
+
+template<std::size_t Width, std::size_t Height, std::size_t Depth>
+void chunk_mesh::rebuild(const chunk<Width, Height, Depth>& chunk) {
+    thread_local scratch_arena arena{};
+    arena.reset();
+    upload(make_chunk_mesh(chunk, arena));
+}
+
+template<std::size_t Width, std::size_t Height, std::size_t Depth>
+void chunk_mesher::mesh(thread_pool& pool, std::span<const chunk<Width, Height, Depth>* const> chunks, std::span<mesh_data> meshes) {
+    begin_batch();
+    pool.parallel_for(chunks.size(), [&](std::size_t index) {
+        meshes[index] = make_chunk_mesh(*chunks[index], arenas_[pool.current_worker()]);
+    });
+    end_batch(chunks.size());
+}
+
+template<std::size_t Width, std::size_t Height, std::size_t Depth>
+void chunk_mesher::mesh_faces(thread_pool& pool, std::span<const chunk<Width, Height, Depth>* const> chunks, std::span<std::span<std::uint32_t>> faces) {
+    begin_batch();
+    pool.parallel_for(chunks.size(), [&](std::size_t index) {
+        faces[index] = make_chunk_faces(*chunks[index], arenas_[pool.current_worker()]);
+    });
+    end_batch(chunks.size());
+}
+
+}
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef JA_COLLISION_H
+#define JA_COLLISION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include <utility/thread_pool.h>
+#include <world/aabb.h>
+#include <world/world.h>
+
+namespace ja {
+
+/**
+ * Outcome of moving a box through the world.
+ */
+struct move_result {
+    /**
+     * Distance the box actually moved.
+     */
+    glm::vec3 moved{};
+
+    /**
+     * Whether motion along an axis was stopped by a block.
+     */
+    glm::bvec3 blocked{false};
+};
+
+/**
+ * Move a box through the world, stopping in front of solid blocks.
+ *
+ * The motion is resolved one axis at a time (y, x, then z), and per axis
+ * only the blocks the box sweeps over are queried. Blocks the box already
+ * overlaps never stop it, so it can always move out of them.
+ */
+move_result move_and_collide(const world& world, aabb& box, glm::vec3 motion);
+
+/**
+ * A box that is moved by the physics simulation.
+ */
+struct body {
+    aabb box{};
+    glm::vec3 velocity{};
+    bool on_ground{};
+};
+
+struct physics_stats {
+    std::size_t bodies{};
+    std::size_t collided{};
+    std::size_t skipped{};
+    float step_ms{};
+};
+
+/**
+ * Simulates many bodies against the blocks of a world.
+ *
+ * As a broad phase, the number of solid blocks of every chunk is cached,
+ * and recounted for the chunks the world reports as changed. Bodies whose
+ * motion stays within empty chunks move without querying any blocks, only
+ * the others are swept against the world. Bodies don't collide with each
+ * other, so they are simulated in parallel.
+ */
+struct physics_world {
+    glm::vec3 gravity{0.0f, -20.0f, 0.0f};
+
+    /**
+     * Add a body and obtain its index.
+     */
+    std::size_t add(const body& body);
+
+    [[nodiscard]] std::span<body> bodies() { return bodies_; }
+    [[nodiscard]] std::span<const body> bodies() const { return bodies_; }
+
+    /**
+     * Advance the simulation by a fixed amount of time.
+     */
+    void step(const world& world, float delta_time, thread_pool& pool);
+
+    [[nodiscard]] const physics_stats& stats() const { return stats_; }
+private:
+    void update_occupancy(const world& world);
+
+    /**
+     * Whether every chunk a box touches is known to be free of blocks.
+     */
+    [[nodiscard]] bool empty_space(const aabb& box) const;
+
+    std::vector<body> bodies_{};
+    std::unordered_map<glm::ivec3, std::size_t, ivec3_hash> solid_blocks_{};
+    std::optional<std::size_t> tracker_{};
+    std::vector<glm::ivec3> changed_{};
+    physics_stats stats_{};
+};
+
+}
+
+#endif
@@ -20,6 +20,14 @@ inline const std::array<cube_face, 6> cube_faces{
     cube_face::top, cube_face::bottom,
 };
 
+/**
+ * Obtain the face on the opposite side of the cube.
+ */
+[[nodiscard]] constexpr cube_face opposite(cube_face face) {
+    // faces are declared in pairs of opposites
+    return static_cast<cube_face>(static_cast<int>(face) ^ 1);
+}
+
 struct cube_vertex {
     glm::vec3 position{};
     glm::vec3 texcoord{};
@@ -29,6 +37,11 @@ inline const std::array<unsigned int, 6> cube_face_indices{0, 1, 2, 0, 2, 3};
 
 [[nodiscard]] std::span<const cube_vertex, 4> cube_face_vertices(cube_face face);
 
+/**
+ * Obtain the outward facing normal of a cube face.
+ */
+[[nodiscard]] glm::ivec3 cube_face_normal(cube_face face);
+
 [[nodiscard]] inline auto cube_vertices() {
     return std::views::transform(cube_faces, cube_face_vertices)
         | std::views::join;
@@ -0,0 +1,166 @@
+#ifndef JA_EDIT_JOURNAL_H
+#define JA_EDIT_JOURNAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include <world/world.h>
+
+namespace ja {
+
+/**
+ * A number of consecutive blocks with the same id.
+ */
+struct block_run {
+    std::uint32_t length{};
+    int block{};
+};
+
+/**
+ * Edits of consecutive blocks of a chunk, in storage order.
+ */
+struct edit_run {
+    glm::ivec3 chunk{};
+    std::uint32_t start{};
+    std::uint32_t count{};
+
+    /**
+     * The blocks before and after the edits, run-length encoded.
+     */
+    std::vector<block_run> before{};
+    std::vector<block_run> after{};
+};
+
+/**
+ * Edits that are undone and redone as a whole.
+ *
+ * Edits of consecutive blocks are merged into runs, so filling or pasting a
+ * region is stored as a handful of runs rather than one record per block.
+ */
+struct edit_batch {
+    /**
+     * Add the edit of a single block.
+     *
+     * @param index Position of the block within the storage order of its chunk.
+     */
+    void add(glm::ivec3 chunk, std::uint32_t index, int before, int after);
+
+    /**
+     * Add edits of consecutive blocks that all become the same block.
+     */
+    void add_run(glm::ivec3 chunk, std::uint32_t start, std::span<const int> before, int after);
+
+    [[nodiscard]] bool empty() const { return runs.empty(); }
+
+    /**
+     * Obtain the number of edited blocks.
+     */
+    [[nodiscard]] std::size_t edit_count() const;
+
+    void clear() { runs.clear(); }
+
+    std::vector<edit_run> runs{};
+};
+
+struct journal_stats {
+    std::size_t operations{};
+    std::size_t edits{};
+    std::size_t bytes{};
+    std::size_t saved_bytes{};
+};
+
+/**
+ * Records the edits made to a world, for undo and redo and for saving them
+ * incrementally.
+ *
+ * Every operation is encoded into a compact log as soon as it's recorded:
+ * varints for the chunk coordinates and positions, and run-length encoded
+ * blocks before and after. Saving appends the part of the log that wasn't
+ * saved yet, so its cost depends on the number of edits rather than on the
+ * number of chunks they touched. Undo and redo are logged as operations of
+ * their own, so replaying the log always reproduces the blocks of the world.
+ * State kept beside the blocks, such as fluid levels, isn't recorded.
+ */
+struct edit_journal {
+    /**
+     * Record the edit of a single block, see world::set_journal.
+     *
+     * Outside of a batch, every edit is an operation of its own.
+     */
+    void record(glm::ivec3 chunk, std::uint32_t index, int before, int after);
+
+    /**
+     * Combine the edits recorded until end_batch into a single operation.
+     */
+    void begin_batch();
+    void end_batch();
+
+    /**
+     * Record edits that were already made to the world as a single operation.
+     */
+    void commit(const edit_batch& batch);
+
+    /**
+     * Revert the latest operation that wasn't undone yet.
+     *
+     * @return Whether there was an operation to undo.
+     */
+    bool undo(world& world);
+
+    /**
+     * Repeat the latest undone operation.
+     *
+     * @return Whether there was an operation to redo.
+     */
+    bool redo(world& world);
+
+    [[nodiscard]] bool can_undo() const { return undone_ < history_.size(); }
+    [[nodiscard]] bool can_redo() const { return undone_ > 0; }
+
+    /**
+     * Append the operations that weren't saved yet to a file.
+     *
+     * The file is created on the first save.
+     *
+     * @return Whether the file could be written.
+     */
+    bool save(const std::string& path);
+
+    [[nodiscard]] journal_stats stats() const;
+private:
+    void append(const edit_batch& batch);
+
+    std::vector<std::uint8_t> log_{};
+    std::size_t saved_{};
+
+    /**
+     * Offsets into the log of the operations that can be undone, the latest
+     * undone_ of which were undone.
+     */
+    std::vector<std::size_t> history_{};
+    std::size_t undone_{};
+
+    edit_batch batch_{};
+    int batch_depth_{};
+    edit_batch scratch_{};
+    std::size_t edits_{};
+};
+
+/**
+ * Apply the operations of a journal file to a world.
+ *
+ * @return Whether the file could be read completely.
+ */
+bool replay_journal(const std::string& path, world& world);
+
+/**
+ * Apply the edits of a batch to a world, or revert them.
+ */
+void apply_edits(world& world, const edit_batch& batch, bool revert = false);
+
+}
+
+#endif
@@ -0,0 +1,143 @@
+#ifndef JA_FACE_MESH_H
+#define JA_FACE_MESH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <ranges>
+#include <span>
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+#include <graphics/buffer.h>
+#include <utility/scratch_arena.h>
+#include <world/block.h>
+#include <world/brick_map.h>
+#include <world/chunk.h>
+#include <world/cube.h>
+
+namespace ja {
+
+/**
+ * Pack a visible block face into 32 bits, as read by res/pulling.vert.
+ *
+ * Bits 0-14 hold the position of the block within its chunk (5 bits per
+ * axis), bits 15-17 the face and bits 18-25 the block id.
+ */
+[[nodiscard]] constexpr std::uint32_t pack_face(glm::uvec3 pos, cube_face face, int block) {
+    static_assert(blocks::atlas_layers <= 256, "block ids are packed into 8 bits");
+    assert(block >= 0 && block < blocks::atlas_layers);
+    return pos.x | (pos.y << 5) | (pos.z << 10)
+        | (static_cast<std::uint32_t>(face) << 15)
+        | (static_cast<std::uint32_t>(block) << 18);
+}
+
+/**
+ * Collect the packed visible faces of the blocks of a chunk.
+ *
+ * Faces are not counted up front: at four bytes each, room for all six
+ * faces of every solid block is cheap, and only the visible ones are kept.
+ */
+template<std::size_t Width, std::size_t Height, std::size_t Depth>
+[[nodiscard]] std::span<std::uint32_t> make_chunk_faces(const chunk<Width, Height, Depth>& chunk, scratch_arena& arena) {
+    static_assert(Width <= 32 && Height <= 32 && Depth <= 32, "block positions are packed into 5 bits per axis");
+
+    const auto solid = static_cast<std::size_t>(std::ranges::count_if(chunk.blocks(), std::not_fn(is_empty)));
+    auto faces = arena.allocate<std::uint32_t>(solid * cube_faces.size());
+    std::size_t face_count{};
+
+    // faces between two blocks of the chunk are never visible
+    auto hidden = [&chunk](glm::ivec3 neighbor) {
+        if (glm::any(glm::lessThan(neighbor, glm::ivec3{0}))) return false;
+        if (glm::any(glm::greaterThanEqual(neighbor, glm::ivec3{Width, Height, Depth}))) return false;
+        return !is_empty(chunk[neighbor.x, neighbor.y, neighbor.z]);
+    };
+
+    for (auto [index, block] : std::views::zip(chunk.indices(), chunk.blocks())) {
+        if (is_empty(block)) continue;
+        auto [i, j, k] = index;
+
+        for (auto face : cube_faces) {
+            if (hidden(glm::ivec3{i, j, k} + cube_face_normal(face))) continue;
+            faces[face_count++] = pack_face(glm::uvec3{i, j, k}, face, block);
+        }
+    }
+
+    return faces.first(face_count);
+}
+
+/**
+ * Collect the packed visible faces of the blocks of a brick map.
+ *
+ * Uniform empty bricks are skipped outright, and of uniform solid bricks
+ * only the outer shell of blocks is visited.
+ */
+template<std::size_t Width, std::size_t Height, std::size_t Depth>
+[[nodiscard]] std::span<std::uint32_t> make_chunk_faces(const brick_map<Width, Height, Depth>& bricks, scratch_arena& arena) {
+    static_assert(Width <= 32 && Height <= 32 && Depth <= 32, "block positions are packed into 5 bits per axis");
+    using map = brick_map<Width, Height, Depth>;
+    constexpr auto size = map::brick_size;
+
+    auto faces = arena.allocate<std::uint32_t>(bricks.solid_count() * cube_faces.size());
+    std::size_t face_count{};
+
+    auto hidden = [&bricks](glm::ivec3 neighbor) {
+        if (glm::any(glm::lessThan(neighbor, glm::ivec3{0}))) return false;
+        if (glm::any(glm::greaterThanEqual(neighbor, glm::ivec3{Width, Height, Depth}))) return false;
+        return !is_empty(bricks[neighbor.x, neighbor.y, neighbor.z]);
+    };
+
+    auto add_block = [&](std::size_t i, std::size_t j, std::size_t k, int block) {
+        for (auto face : cube_faces) {
+            if (hidden(glm::ivec3{i, j, k} + cube_face_normal(face))) continue;
+            faces[face_count++] = pack_face(glm::uvec3{i, j, k}, face, block);
+        }
+    };
+
+    for (auto [bx, by, bz] : std::views::cartesian_product(std::views::iota(0uz, map::bricks_x), std::views::iota(0uz, map::bricks_y), std::views::iota(0uz, map::bricks_z))) {
+        const bool uniform = bricks.uniform(bx, by, bz);
+        if (uniform && is_empty(bricks.uniform_block(bx, by, bz))) continue;
+
+        for (auto [x, y] : std::views::cartesian_product(std::views::iota(0uz, size), std::views::iota(0uz, size))) {
+            // blocks inside a solid brick are surrounded by solid blocks
+            const bool inner = uniform && x > 0 && x < size - 1 && y > 0 && y < size - 1;
+            const auto z_step = inner ? size - 1 : 1;
+
+            for (std::size_t z{}; z < size; z += z_step) {
+                const auto i = bx * size + x, j = by * size + y, k = bz * size + z;
+                const int block = bricks[i, j, k];
+                if (!is_empty(block)) add_block(i, j, k, block);
+            }
+        }
+    }
+
+    return faces.first(face_count);
+}
+
+/**
+ * The GPU side of a chunk for vertex pulling: a storage buffer with one
+ * packed record per visible face, expanded into quads by the vertex shader.
+ */
+struct chunk_face_mesh {
+    /**
+     * Replace the faces with previously generated ones.
+     */
+    void upload(std::span<const std::uint32_t> faces);
+
+    /**
+     * Bind the faces to a shader storage buffer binding point.
+     */
+    void bind(GLuint index) const;
+
+    [[nodiscard]] std::size_t face_count() const { return face_count_; }
+    [[nodiscard]] std::size_t vertex_count() const { return face_count_ * cube_face_indices.size(); }
+    [[nodiscard]] std::size_t geometry_bytes() const { return face_count_ * sizeof(std::uint32_t); }
+private:
+    buffer_handle ssbo_{make_buffer()};
+    std::size_t face_count_{};
+};
+
+}
+
+#endif
@@ -0,0 +1,171 @@
+#ifndef JA_FLUID_H
+#define JA_FLUID_H
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include <utility/thread_pool.h>
+#include <world/world.h>
+
+namespace ja {
+
+/**
+ * Fluid levels go from 0 (dry) to max_fluid_level, sources are flagged and never change.
+ */
+inline constexpr std::uint8_t max_fluid_level{8};
+inline constexpr std::uint8_t fluid_source{0x80};
+
+[[nodiscard]] constexpr int fluid_level(std::uint8_t cell) {
+    return cell & 0x0f;
+}
+
+/**
+ * The fluid levels of a chunk.
+ *
+ * Levels are double buffered: a step computes the next levels of the
+ * active cells from the current levels of the chunk and its neighbors, so
+ * chunks can be stepped in parallel without seeing each other's updates.
+ */
+struct fluid_chunk {
+    [[nodiscard]] std::uint8_t operator[](std::uint32_t index) const { return levels[front][index]; }
+
+    std::array<std::array<std::uint8_t, world_chunk::volume>, 2> levels{};
+    std::size_t front{};
+
+    /**
+     * Cells to update in the next step, without duplicates.
+     */
+    std::vector<std::uint32_t> active{};
+    std::bitset<world_chunk::volume> queued{};
+
+    /**
+     * Revision of the blocks of the chunk the levels were computed for.
+     */
+    std::uint64_t block_revision{};
+
+    /**
+     * Bumped whenever the visible surface of the fluid changes.
+     */
+    std::uint64_t revision{1};
+};
+
+struct fluid_stats {
+    std::size_t chunks{};
+
+    /**
+     * Number of cells that were updated and how many of them changed.
+     */
+    std::size_t updated{};
+    std::size_t changed{};
+
+    /**
+     * Number of chunks whose visible surface changed.
+     */
+    std::size_t remeshed{};
+
+    float ms{};
+};
+
+struct fluid_simulation;
+
+/**
+ * Lookups of blocks and fluid levels around a chunk, which remember the chunks they used.
+ *
+ * Only the chunk and its neighbors can be looked up, missing chunks of the
+ * world count as solid, so fluids stay within the world.
+ */
+struct fluid_neighborhood {
+    fluid_neighborhood(const fluid_simulation& fluids, const world& world, glm::ivec3 coord)
+        : fluids_{fluids}, world_{world}, coord_{coord} {}
+
+    [[nodiscard]] bool solid(glm::ivec3 pos) const;
+    [[nodiscard]] std::uint8_t cell(glm::ivec3 pos) const;
+    [[nodiscard]] int level(glm::ivec3 pos) const { return fluid_level(cell(pos)); }
+private:
+    [[nodiscard]] std::size_t slot(glm::ivec3 pos) const;
+
+    const fluid_simulation& fluids_;
+    const world& world_;
+    glm::ivec3 coord_{};
+    mutable std::array<const world_chunk*, 27> blocks_{};
+    mutable std::array<const fluid_chunk*, 27> cells_{};
+    mutable std::uint32_t looked_up_{};
+};
+
+/**
+ * Water-like fluids flowing through the empty blocks of a world.
+ *
+ * Fluid falls down as far as it can and spreads sideways from cells that
+ * rest on something solid or on a source, losing a level with every block.
+ * Only the cells next to ones that changed are updated in the next step,
+ * so still fluid costs nothing. Changes to the blocks of a chunk wake up
+ * the fluid in and around it.
+ *
+ * Fluid levels are kept apart from the blocks, which the simulation only
+ * reads, so they aren't part of a world's edit journal.
+ */
+struct fluid_simulation {
+    /**
+     * Place a source, which fails if the block isn't empty or its chunk doesn't exist.
+     */
+    bool add_source(const world& world, glm::ivec3 pos);
+    void remove_source(const world& world, glm::ivec3 pos);
+
+    /**
+     * Run one step of the simulation for all active cells.
+     */
+    void step(const world& world, thread_pool& pool);
+
+    [[nodiscard]] int level(glm::ivec3 pos) const;
+    [[nodiscard]] const fluid_chunk* find(glm::ivec3 chunk) const;
+
+    /**
+     * Obtain the revision of the visible surface of the fluid in a chunk, 0 if it never had any.
+     */
+    [[nodiscard]] std::uint64_t revision(glm::ivec3 chunk) const;
+
+    [[nodiscard]] std::size_t active_cells() const;
+    [[nodiscard]] std::size_t wet_cells() const;
+    [[nodiscard]] const fluid_stats& stats() const { return stats_; }
+private:
+    struct task {
+        glm::ivec3 coord{};
+        fluid_chunk* fluid{};
+        std::size_t updated{};
+        std::vector<std::uint32_t> changed{};
+        std::vector<std::uint8_t> previous{};
+    };
+
+    /**
+     * Obtain the fluid of a chunk, creating it if needed.
+     */
+    fluid_chunk& emplace(const world& world, glm::ivec3 chunk);
+
+    /**
+     * Queue a cell for the next step.
+     */
+    void activate(const world& world, glm::ivec3 pos);
+
+    /**
+     * Queue the cells whose next level depends on a cell.
+     */
+    void activate_dependents(const world& world, glm::ivec3 pos);
+
+    /**
+     * Mark the surface of a chunk as changed, and of the neighbors that share a face of the cell if it (dis)appeared.
+     */
+    void touch(glm::ivec3 pos, bool appeared);
+
+    std::unordered_map<glm::ivec3, fluid_chunk, ivec3_hash> chunks_{};
+    std::vector<task> tasks_{};
+    std::vector<glm::ivec3> changed_blocks_{};
+    fluid_stats stats_{};
+};
+
+}
+
+#endif
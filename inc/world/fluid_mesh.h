@@ -0,0 +1,36 @@
+#ifndef JA_FLUID_MESH_H
+#define JA_FLUID_MESH_H
+
+#include <span>
+#include <vector>
+#include <glm/glm.hpp>
+#include <utility/scratch_arena.h>
+#include <world/cube.h>
+#include <world/fluid.h>
+#include <world/world.h>
+
+namespace ja {
+
+/**
+ * Generate the faces of the fluid in a chunk, relative to the chunk.
+ *
+ * Faces are only generated where fluid borders empty space, and the top of
+ * fluid with nothing above is lowered according to its level.
+ *
+ * @param vertices Receives four vertices per face.
+ */
+void make_fluid_mesh(const fluid_simulation& fluids, const world& world, glm::ivec3 chunk, std::vector<cube_vertex>& vertices);
+
+/**
+ * Order the faces of a mesh from back to front, as translucent faces have to be drawn.
+ *
+ * @param vertices Four vertices per face.
+ * @param eye The point the faces are seen from, relative to the mesh.
+ * @param arena Scratch memory for the sort, which is reset first.
+ * @param indices Receives the indices of the triangles of the faces.
+ */
+void sort_back_to_front(std::span<const cube_vertex> vertices, glm::vec3 eye, scratch_arena& arena, std::vector<unsigned int>& indices);
+
+}
+
+#endif
@@ -0,0 +1,172 @@
+#ifndef JA_NAVIGATION_H
+#define JA_NAVIGATION_H
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include <utility/thread_pool.h>
+#include <world/world.h>
+
+namespace ja {
+
+/**
+ * A path from one cell to another, both included, empty if there is none.
+ */
+using nav_path = std::vector<glm::ivec3>;
+
+struct nav_query {
+    glm::ivec3 start{};
+    glm::ivec3 goal{};
+};
+
+struct nav_stats {
+    std::size_t clusters{};
+    std::size_t nodes{};
+    std::size_t edges{};
+
+    /**
+     * Number of clusters whose cells or edges were recomputed by the last update.
+     */
+    std::size_t rebuilt{};
+    float update_ms{};
+};
+
+/**
+ * Paths for agents two blocks tall, using hierarchical pathfinding (HPA*).
+ *
+ * Agents stand in empty cells above solid blocks, and move to one of the
+ * four neighboring cells, stepping up or down by at most one block. Every
+ * chunk is a cluster: contiguous stretches of moves across the border of
+ * two clusters form an entrance, which is a pair of abstract nodes, and
+ * the nodes within a cluster are connected by their shortest distance
+ * within it. Queries search the abstract graph and then expand its edges
+ * into cells, which only takes a search within the clusters of the start
+ * and the goal.
+ *
+ * Updates only recompute the clusters whose chunks changed, along with the
+ * entrances and edges of their neighbors. Queries don't change the graph,
+ * so a batch of them runs in parallel.
+ */
+struct nav_graph {
+    explicit nav_graph(const thread_pool& pool)
+        :scratch_(pool.size() + 1) {}
+
+    /**
+     * Bring the graph up to date with the blocks of the world.
+     */
+    void update(const world& world, thread_pool& pool);
+
+    /**
+     * Whether an agent can stand in a cell.
+     */
+    [[nodiscard]] bool walkable(glm::ivec3 cell) const;
+
+    /**
+     * Find a path between two walkable cells.
+     *
+     * @return Whether there is a path.
+     */
+    bool find_path(const nav_query& query, nav_path& path);
+
+    /**
+     * Find paths for a batch of queries on a thread pool.
+     */
+    void find_paths(thread_pool& pool, std::span<const nav_query> queries, std::span<nav_path> paths);
+
+    [[nodiscard]] nav_stats stats() const;
+private:
+    struct edge {
+        std::uint32_t to{};
+        std::uint32_t cost{};
+
+        /**
+         * Offset of the cells of an edge within a cluster in the steps of its node, one per move.
+         */
+        std::uint32_t first{};
+    };
+
+    struct node {
+        glm::ivec3 cell{};
+
+        /**
+         * The node on the other side of the entrance.
+         */
+        std::uint32_t partner{};
+        std::vector<edge> edges{};
+
+        /**
+         * Local indices of the cells along the edges within the cluster, so paths don't need to be searched again.
+         */
+        std::vector<std::uint16_t> steps{};
+    };
+
+    struct cluster {
+        std::bitset<world_chunk::volume> walkable{};
+
+        /**
+         * Cells with room above the head of an agent, so it can step up from them.
+         */
+        std::bitset<world_chunk::volume> headroom{};
+
+        std::uint64_t revision{};
+        std::vector<std::uint32_t> nodes{};
+    };
+
+    /**
+     * Search state of one thread.
+     */
+    struct scratch {
+        std::vector<std::uint32_t> cost{};
+        std::vector<std::uint32_t> parent{};
+        std::vector<std::uint32_t> visited{};
+        std::vector<std::uint32_t> goal_cost{};
+        std::vector<std::uint32_t> goal_visited{};
+        std::uint32_t generation{};
+
+        // breadth-first search within a cluster
+        std::vector<std::uint16_t> cell_cost{};
+        std::vector<std::uint16_t> cell_parent{};
+        std::vector<std::uint32_t> cell_visited{};
+        std::vector<std::uint16_t> queue{};
+        std::uint32_t cell_generation{};
+    };
+
+    using cluster_map = std::unordered_map<glm::ivec3, cluster, ivec3_hash>;
+
+    [[nodiscard]] const cluster* find(glm::ivec3 coord) const;
+
+    /**
+     * Breadth-first search from a cell within its cluster, until a target cell is reached if given.
+     */
+    void search_cluster(scratch& scratch, const cluster& cluster, glm::ivec3 coord, glm::ivec3 start, const glm::ivec3* target) const;
+
+    bool find_path(scratch& scratch, const nav_query& query, nav_path& path) const;
+
+    /**
+     * Append the path found by the last cluster search, from its start to some cell.
+     */
+    static void append_cluster_path(const scratch& scratch, glm::ivec3 origin, glm::ivec3 cell, nav_path& path);
+
+    /**
+     * Make sure every thread of a pool has scratch memory, in case it is larger than the pool the graph was made for.
+     */
+    void fit_scratch(const thread_pool& pool);
+
+    void remove_entrances(glm::ivec3 a, glm::ivec3 b);
+    void connect(const cluster& cluster, glm::ivec3 coord, scratch& scratch);
+
+    cluster_map clusters_{};
+    std::vector<node> nodes_{};
+    std::vector<std::uint32_t> free_nodes_{};
+    std::vector<scratch> scratch_{};
+    std::size_t rebuilt_{};
+    float update_ms_{};
+};
+
+}
+
+#endif
@@ -0,0 +1,165 @@
+#ifndef JA_OCCLUSION_H
+#define JA_OCCLUSION_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <glm/glm.hpp>
+#include <utility/thread_pool.h>
+#include <world/aabb.h>
+#include <world/chunk.h>
+
+namespace ja {
+
+/**
+ * A planar quad, given in world space, that hides whatever is behind it.
+ */
+using occluder = std::array<glm::vec3, 4>;
+
+struct occlusion_stats {
+    std::size_t occluders{};
+    std::size_t tested{};
+    std::size_t culled{};
+    float raster_ms{};
+    float test_ms{};
+};
+
+/**
+ * Software occlusion culling using a low resolution depth buffer.
+ *
+ * Occluders are rasterized on the CPU, only writing pixels they cover
+ * entirely and always the farthest depth within those pixels, so they never
+ * hide more than they should. Boxes are then tested against a hierarchy of
+ * maximum depths built from that buffer.
+ */
+struct occlusion_culler {
+    /**
+     * Number of rows that make up a tile, tiles are rasterized in parallel.
+     */
+    static constexpr std::size_t tile_height{16};
+
+    /**
+     * @param width Width of the depth buffer, rounded up to a multiple of 16.
+     * @param height Height of the depth buffer.
+     */
+    explicit occlusion_culler(std::size_t width = 320, std::size_t height = 180);
+
+    /**
+     * Start a new frame, discarding all occluders.
+     */
+    void begin(const glm::mat4& view_proj);
+
+    void add_occluder(const occluder& quad);
+
+    /**
+     * Rasterize all occluders and build the depth hierarchy.
+     */
+    void rasterize(thread_pool& pool);
+
+    /**
+     * Test which boxes may be visible.
+     *
+     * @param boxes Bounding boxes in world space.
+     * @param visible Receives a nonzero value for every box that may be visible.
+     */
+    void test(std::span<const aabb> boxes, std::span<std::uint8_t> visible);
+
+    /**
+     * Whether a box may be visible, boxes that are outside the view are not.
+     */
+    [[nodiscard]] bool visible(const aabb& box) const;
+
+    [[nodiscard]] const occlusion_stats& stats() const { return stats_; }
+    [[nodiscard]] std::size_t width() const { return width_; }
+    [[nodiscard]] std::size_t height() const { return height_; }
+
+    /**
+     * Obtain the rasterized depth buffer, row by row from the bottom of the screen.
+     */
+    [[nodiscard]] std::span<const float> depth() const { return levels_.front(); }
+private:
+    /**
+     * A screen space triangle in edge function form.
+     */
+    struct triangle {
+        std::array<glm::vec3, 3> edges{};
+        glm::vec3 plane{};
+        float depth_margin{};
+        int min_y{};
+        int max_y{};
+        int min_x{};
+        int max_x{};
+    };
+
+    void add_triangle(glm::vec3 a, glm::vec3 b, glm::vec3 c);
+    void rasterize_tile(std::size_t tile);
+    void build_hierarchy();
+
+    std::size_t width_{};
+    std::size_t height_{};
+    glm::mat4 view_proj_{1.0f};
+    std::vector<triangle> triangles_{};
+    std::vector<std::vector<float>> levels_{};
+    std::vector<glm::ivec2> level_sizes_{};
+    occlusion_stats stats_{};
+};
+
+/**
+ * Collect conservative occluders of a chunk.
+ *
+ * For every axis, the first and last slice of blocks that is entirely solid
+ * contributes a quad through the middle of that slice.
+ *
+ * @param origin World space position of the center of block (0, 0, 0).
+ */
+template<std::size_t Width, std::size_t Height, std::size_t Depth>
+void collect_occluders(const chunk<Width, Height, Depth>& chunk, glm::vec3 origin, std::vector<occluder>& occluders) {
+    constexpr std::array<std::size_t, 3> extent{Width, Height, Depth};
+
+    for (std::size_t axis = 0; axis < 3; ++axis) {
+        const std::size_t u = (axis + 1) % 3;
+        const std::size_t v = (axis + 2) % 3;
+
+        auto solid = [&](std::size_t slice) {
+            for (std::size_t a = 0; a < extent[u]; ++a) {
+                for (std::size_t b = 0; b < extent[v]; ++b) {
+                    std::array<std::size_t, 3> index{};
+                    index[axis] = slice;
+                    index[u] = a;
+                    index[v] = b;
+                    if (is_empty(chunk[index[0], index[1], index[2]])) return false;
+                }
+            }
+            return true;
+        };
+
+        auto emit = [&](std::size_t slice) {
+            glm::vec3 min = origin - 0.5f;
+            glm::vec3 max = min + glm::vec3{Width, Height, Depth};
+            min[axis] = max[axis] = origin[axis] + static_cast<float>(slice);
+
+            occluder quad{min, min, max, max};
+            quad[1][u] = max[u];
+            quad[3][u] = min[u];
+            occluders.push_back(quad);
+        };
+
+        std::size_t first = 0;
+        while (first < extent[axis] && !solid(first)) ++first;
+        if (first == extent[axis]) continue;
+
+        std::size_t last = extent[axis] - 1;
+        while (last > first && !solid(last)) --last;
+
+        emit(first);
+        if (last != first) {
+            emit(last);
+        }
+    }
+}
+
+}
+
+#endif
@@ -0,0 +1,146 @@
+#ifndef JA_RAYCAST_H
+#define JA_RAYCAST_H
+
+#include <cstddef>
+#include <optional>
+#include <glm/glm.hpp>
+#include <world/block.h>
+#include <world/brick_map.h>
+#include <world/chunk.h>
+#include <world/cube.h>
+
+namespace ja {
+
+struct raycast_hit {
+    /**
+     * Coordinates of the block that was hit, local to the chunk.
+     */
+    glm::ivec3 block{};
+
+    /**
+     * Face of the block the ray entered through.
+     */
+    cube_face face{};
+
+    float distance{};
+};
+
+/**
+ * Where a ray enters a box from the origin to some size.
+ */
+struct ray_entry {
+    float distance{};
+    int axis{};
+};
+
+/**
+ * Find where a ray enters a box, if it does.
+ *
+ * Rays starting inside the box enter it at distance 0, along their main axis.
+ */
+[[nodiscard]] std::optional<ray_entry> enter_box(glm::vec3 origin, glm::vec3 direction, glm::vec3 size);
+
+/**
+ * Steps through the cells of a grid along a ray, in the order the ray crosses them.
+ *
+ * Cells lie on multiples of the cell size, and the walk is limited to a range of them.
+ */
+struct grid_walk {
+    /**
+     * Start the walk from a point along the ray, entered along an axis.
+     */
+    grid_walk(glm::vec3 origin, glm::vec3 direction, float cell_size, ray_entry start, glm::ivec3 min_cell, glm::ivec3 max_cell);
+
+    /**
+     * Move on to the next cell along the ray.
+     */
+    void next();
+
+    [[nodiscard]] bool inside() const {
+        return glm::all(glm::greaterThanEqual(cell_, min_cell_)) && glm::all(glm::lessThanEqual(cell_, max_cell_));
+    }
+
+    [[nodiscard]] glm::ivec3 cell() const { return cell_; }
+
+    /**
+     * Obtain the distance along the ray at which the current cell was entered.
+     */
+    [[nodiscard]] float distance() const { return distance_; }
+
+    /**
+     * Obtain how the current cell was entered, to start a finer walk from.
+     */
+    [[nodiscard]] ray_entry entry() const { return {distance_, axis_}; }
+
+    /**
+     * Obtain the face of the current cell the ray entered through.
+     */
+    [[nodiscard]] cube_face entered() const;
+private:
+    glm::ivec3 cell_{};
+    glm::ivec3 step_{};
+    glm::vec3 next_distance_{};
+    glm::vec3 delta_distance_{};
+    glm::ivec3 min_cell_{};
+    glm::ivec3 max_cell_{};
+    float distance_{};
+    int axis_{};
+};
+
+/**
+ * Find the first solid block of a chunk along a ray, in the local coordinates of the chunk.
+ */
+template<std::size_t Width, std::size_t Height, std::size_t Depth>
+[[nodiscard]] std::optional<raycast_hit> raycast(const chunk<Width, Height, Depth>& chunk, glm::vec3 origin, glm::vec3 direction, float max_distance) {
+    // blocks are centered on integer coordinates, the grid walk expects them to start there
+    origin += glm::vec3{0.5f};
+    direction = glm::normalize(direction);
+
+    const auto entry = enter_box(origin, direction, glm::vec3{Width, Height, Depth});
+    if (!entry || entry->distance > max_distance) return std::nullopt;
+
+    for (grid_walk walk{origin, direction, 1.0f, *entry, glm::ivec3{0}, glm::ivec3{Width, Height, Depth} - 1}; walk.inside() && walk.distance() <= max_distance; walk.next()) {
+        const auto cell = walk.cell();
+        if (!is_empty(chunk[cell.x, cell.y, cell.z])) return raycast_hit{cell, walk.entered(), walk.distance()};
+    }
+
+    return std::nullopt;
+}
+
+/**
+ * Find the first solid block of a brick map along a ray, in the local coordinates of the chunk.
+ *
+ * The ray walks from brick to brick, crossing uniform empty bricks in a single step.
+ */
+template<std::size_t Width, std::size_t Height, std::size_t Depth>
+[[nodiscard]] std::optional<raycast_hit> raycast(const brick_map<Width, Height, Depth>& bricks, glm::vec3 origin, glm::vec3 direction, float max_distance) {
+    using map = brick_map<Width, Height, Depth>;
+    constexpr auto size = static_cast<int>(map::brick_size);
+
+    origin += glm::vec3{0.5f};
+    direction = glm::normalize(direction);
+
+    const auto entry = enter_box(origin, direction, glm::vec3{Width, Height, Depth});
+    if (!entry || entry->distance > max_distance) return std::nullopt;
+
+    const glm::ivec3 brick_count{map::bricks_x, map::bricks_y, map::bricks_z};
+    for (grid_walk outer{origin, direction, static_cast<float>(size), *entry, glm::ivec3{0}, brick_count - 1}; outer.inside() && outer.distance() <= max_distance; outer.next()) {
+        const auto brick = outer.cell();
+        const bool uniform = bricks.uniform(brick.x, brick.y, brick.z);
+        if (uniform && is_empty(bricks.uniform_block(brick.x, brick.y, brick.z))) continue;
+
+        grid_walk inner{origin, direction, 1.0f, outer.entry(), brick * size, brick * size + (size - 1)};
+        if (uniform) return raycast_hit{inner.cell(), inner.entered(), inner.distance()};
+
+        for (; inner.inside() && inner.distance() <= max_distance; inner.next()) {
+            const auto cell = inner.cell();
+            if (!is_empty(bricks[cell.x, cell.y, cell.z])) return raycast_hit{cell, inner.entered(), inner.distance()};
+        }
+    }
+
+    return std::nullopt;
+}
+
+}
+
+#endif
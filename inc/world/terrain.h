@@ -0,0 +1,50 @@
+#ifndef JA_TERRAIN_H
+#define JA_TERRAIN_H
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <utility/thread_pool.h>
+#include <world/world.h>
+
+namespace ja {
+
+/**
+ * Parameters of the procedural terrain.
+ */
+struct terrain_params {
+    std::uint32_t seed{1337};
+
+    /**
+     * Height of the surface is base_height plus up to amplitude blocks.
+     */
+    int base_height{16};
+    int amplitude{24};
+
+    /**
+     * Horizontal frequency of the height map.
+     */
+    float scale{0.015f};
+
+    /**
+     * Frequency of the cave noise and the noise value above which blocks are carved out.
+     */
+    float cave_scale{0.06f};
+    float cave_threshold{0.62f};
+};
+
+/**
+ * Obtain the height of the surface at some column.
+ */
+[[nodiscard]] int terrain_height(int x, int z, const terrain_params& params = {});
+
+/**
+ * Fill a box of chunks with procedural hills and caves.
+ *
+ * @param min_chunk Coordinates of the first chunk.
+ * @param max_chunk Coordinates one past the last chunk.
+ */
+void generate_terrain(world& world, glm::ivec3 min_chunk, glm::ivec3 max_chunk, thread_pool& pool, const terrain_params& params = {});
+
+}
+
+#endif
@@ -0,0 +1,211 @@
+#ifndef JA_TICK_SCHEDULER_H
+#define JA_TICK_SCHEDULER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include <utility/thread_pool.h>
+#include <world/edit_journal.h>
+#include <world/world.h>
+
+namespace ja {
+
+/**
+ * A block update that is due at some tick.
+ */
+struct scheduled_tick {
+    std::uint64_t tick{};
+
+    /**
+     * Order in which the tick was scheduled within its chunk, to break ties deterministically.
+     */
+    std::uint64_t order{};
+
+    std::uint32_t index{};
+
+    /**
+     * The block the tick was scheduled for, it is dropped if the block changed meanwhile.
+     */
+    int block{};
+
+    [[nodiscard]] bool operator>(const scheduled_tick& other) const {
+        return tick != other.tick ? tick > other.tick : order > other.order;
+    }
+};
+
+/**
+ * The ticks of a chunk, and the number of its blocks that have random ticks.
+ */
+struct chunk_ticks {
+    std::priority_queue<scheduled_tick, std::vector<scheduled_tick>, std::greater<>> queue{};
+    std::uint64_t next_order{};
+
+    /**
+     * Revision of the chunk the blocks with random ticks were counted at.
+     */
+    std::uint64_t revision{};
+    std::size_t random_blocks{};
+};
+
+/**
+ * What a tick handler may do while its chunk is being ticked.
+ *
+ * Blocks can be read within the chunk and its neighbors, blocks further
+ * away read as empty. Changes to the chunk itself are applied right away,
+ * changes to other chunks once every chunk of the phase has been ticked.
+ */
+struct tick_context {
+    [[nodiscard]] int get_block(glm::ivec3 pos) const;
+    void set_block(glm::ivec3 pos, int block);
+
+    /**
+     * Schedule a tick for the block at some position, at least one tick from now.
+     */
+    void schedule(glm::ivec3 pos, std::uint32_t delay);
+
+    /**
+     * Obtain a random number, which only depends on the seed, the chunk and the tick.
+     */
+    [[nodiscard]] std::uint32_t random();
+
+    [[nodiscard]] std::uint64_t tick() const { return tick_; }
+private:
+    friend struct tick_scheduler;
+
+    struct deferred_block {
+        glm::ivec3 pos{};
+        int block{};
+    };
+
+    struct deferred_tick {
+        glm::ivec3 pos{};
+        std::uint32_t delay{};
+    };
+
+    void reset(world& world, glm::ivec3 coord, chunk_ticks& ticks, std::uint64_t tick, std::uint64_t seed);
+
+    world* world_{};
+    glm::ivec3 coord_{};
+    chunk_ticks* ticks_{};
+    std::uint64_t tick_{};
+    std::uint64_t random_{};
+
+    /**
+     * The chunk and its neighbors, looked up on first use.
+     */
+    world_chunk* chunk_{};
+    mutable std::array<const world_chunk*, 27> neighbors_{};
+    mutable std::uint32_t looked_up_{};
+
+    bool changed_{};
+    std::size_t scheduled_count_{};
+    std::size_t random_count_{};
+    std::vector<deferred_block> blocks_{};
+    std::vector<deferred_tick> scheduled_{};
+
+    // the edits made to the chunk, if the world has a journal
+    edit_batch edits_{};
+};
+
+/**
+ * @param pos Coordinates of the ticked block.
+ * @param block The ticked block.
+ */
+using tick_handler = std::function<void(tick_context& context, glm::ivec3 pos, int block)>;
+
+struct tick_stats {
+    std::size_t active_chunks{};
+    std::size_t skipped_chunks{};
+
+    /**
+     * Number of handlers that ran for scheduled and random ticks.
+     */
+    std::size_t scheduled{};
+    std::size_t random{};
+
+    float ms{};
+};
+
+/**
+ * Runs scheduled and random block updates.
+ *
+ * Every chunk has a queue of ticks scheduled for its blocks, and every tick
+ * a few random blocks of each chunk get a random tick, like grass spreading
+ * in Minecraft. Chunks with neither due ticks nor blocks that have random
+ * ticks are skipped.
+ *
+ * Chunks are ticked in eight phases by the parity of their coordinates, so
+ * the chunks ticked in parallel are never neighbors: a handler writes only
+ * to its own chunk and reads only from chunks no other handler writes to.
+ * Together with per-chunk random numbers and applying changes to other
+ * chunks in a fixed order, this makes ticks deterministic without locks.
+ */
+struct tick_scheduler {
+    explicit tick_scheduler(std::uint64_t seed = 0) : seed_{seed} {}
+
+    /**
+     * Set what happens when a scheduled tick of a block is due.
+     */
+    void on_scheduled(int block, tick_handler handler);
+
+    /**
+     * Set what happens when a block gets a random tick.
+     */
+    void on_random(int block, tick_handler handler);
+
+    /**
+     * Schedule a tick for the block at some position.
+     */
+    void schedule(const world& world, glm::ivec3 pos, std::uint32_t delay);
+
+    /**
+     * Run one tick.
+     *
+     * If the world has a journal, the blocks changed by the tick are recorded
+     * as a single operation.
+     */
+    void tick(world& world, thread_pool& pool);
+
+    /**
+     * Number of random ticks per chunk and tick.
+     */
+    int random_ticks{3};
+
+    [[nodiscard]] std::uint64_t current_tick() const { return tick_; }
+    [[nodiscard]] std::size_t pending() const;
+    [[nodiscard]] const tick_stats& stats() const { return stats_; }
+private:
+    struct active_chunk {
+        glm::ivec3 coord{};
+        chunk_ticks* ticks{};
+    };
+
+    struct stale_chunk {
+        chunk_ticks* ticks{};
+        const world_chunk* chunk{};
+        std::uint64_t revision{};
+    };
+
+    void run(tick_context& context) const;
+    void count_random_blocks(const world& world, thread_pool& pool);
+
+    std::uint64_t seed_{};
+    std::uint64_t tick_{};
+    std::vector<tick_handler> scheduled_handlers_{};
+    std::vector<tick_handler> random_handlers_{};
+    std::unordered_map<glm::ivec3, chunk_ticks, ivec3_hash> chunks_{};
+
+    std::vector<stale_chunk> stale_{};
+    std::array<std::vector<active_chunk>, 8> phases_{};
+    std::vector<tick_context> contexts_{};
+    tick_stats stats_{};
+};
+
+}
+
+#endif
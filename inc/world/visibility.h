@@ -0,0 +1,173 @@
+#ifndef JA_VISIBILITY_H
+#define JA_VISIBILITY_H
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include <utility/thread_pool.h>
+#include <world/chunk.h>
+#include <world/cube.h>
+#include <world/world.h>
+
+namespace ja {
+
+/**
+ * Which faces of a chunk can be seen from which other faces, through the empty blocks of the chunk.
+ */
+struct face_connectivity {
+    /**
+     * A symmetric 6 x 6 matrix, indexed by cube_face.
+     */
+    std::uint64_t bits{};
+
+    [[nodiscard]] bool connected(cube_face a, cube_face b) const {
+        return bits & bit(a, b);
+    }
+
+    void connect(cube_face a, cube_face b) {
+        bits |= bit(a, b) | bit(b, a);
+    }
+
+    /**
+     * Connectivity of a chunk without any blocks.
+     */
+    [[nodiscard]] static face_connectivity all() {
+        return face_connectivity{(1ull << 36) - 1};
+    }
+private:
+    [[nodiscard]] static std::uint64_t bit(cube_face a, cube_face b) {
+        return 1ull << (static_cast<unsigned int>(a) * 6 + static_cast<unsigned int>(b));
+    }
+};
+
+/**
+ * Compute the face connectivity of a chunk by flood filling its empty blocks.
+ */
+template<std::size_t Width, std::size_t Height, std::size_t Depth>
+[[nodiscard]] face_connectivity compute_connectivity(const chunk<Width, Height, Depth>& chunk) {
+    // bit mask of the faces of the chunk that a block touches
+    auto faces_of = [](std::size_t i, std::size_t j, std::size_t k) {
+        std::uint8_t faces{};
+        auto add = [&faces](bool touches, cube_face face) {
+            if (touches) faces |= static_cast<std::uint8_t>(1u << static_cast<unsigned int>(face));
+        };
+        add(k == Depth - 1, cube_face::front);
+        add(k == 0, cube_face::back);
+        add(i == 0, cube_face::left);
+        add(i == Width - 1, cube_face::right);
+        add(j == Height - 1, cube_face::top);
+        add(j == 0, cube_face::bottom);
+        return faces;
+    };
+
+    auto index_of = [](std::size_t i, std::size_t j, std::size_t k) {
+        return (i * Height + j) * Depth + k;
+    };
+
+    std::bitset<Width * Height * Depth> visited{};
+    thread_local std::vector<std::array<std::size_t, 3>> stack{};
+
+    face_connectivity result{};
+
+    for (auto [i, j, k] : chunk.indices()) {
+        // pockets that don't touch a face of the chunk don't matter
+        if (faces_of(i, j, k) == 0) continue;
+        if (visited[index_of(i, j, k)] || !is_empty(chunk[i, j, k])) continue;
+
+        std::uint8_t faces{};
+        visited[index_of(i, j, k)] = true;
+        stack.push_back({i, j, k});
+
+        while (!stack.empty()) {
+            const auto [x, y, z] = stack.back();
+            stack.pop_back();
+            faces |= faces_of(x, y, z);
+
+            auto visit = [&](std::size_t u, std::size_t v, std::size_t w) {
+                if (visited[index_of(u, v, w)] || !is_empty(chunk[u, v, w])) return;
+                visited[index_of(u, v, w)] = true;
+                stack.push_back({u, v, w});
+            };
+
+            if (x > 0) visit(x - 1, y, z);
+            if (x + 1 < Width) visit(x + 1, y, z);
+            if (y > 0) visit(x, y - 1, z);
+            if (y + 1 < Height) visit(x, y + 1, z);
+            if (z > 0) visit(x, y, z - 1);
+            if (z + 1 < Depth) visit(x, y, z + 1);
+        }
+
+        for (auto a : cube_faces) {
+            if (!(faces & (1u << static_cast<unsigned int>(a)))) continue;
+            for (auto b : cube_faces) {
+                if (faces & (1u << static_cast<unsigned int>(b))) {
+                    result.connect(a, b);
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+struct visibility_stats {
+    std::size_t visible{};
+    std::size_t recomputed{};
+    float update_ms{};
+    float search_ms{};
+};
+
+/**
+ * Cached face connectivity of the chunks of a world, used to find the
+ * chunks that may be visible from the camera without looking at any depth.
+ *
+ * Starting at the chunk of the camera, a breadth-first search steps from
+ * chunk to chunk, only leaving a chunk through faces that are connected to
+ * the face it was entered through and never turning back towards the camera.
+ */
+struct visibility_graph {
+    /**
+     * Recompute the connectivity of chunks that changed since the last update.
+     *
+     * A graph follows the changes of the first world it is updated with.
+     */
+    void update(const world& world, thread_pool& pool);
+
+    /**
+     * Collect the chunks that may be visible.
+     *
+     * @param position Position of the camera.
+     * @param forward Direction the camera is looking in.
+     * @param chunks Receives the coordinates of the visible chunks.
+     */
+    void visible_chunks(glm::vec3 position, glm::vec3 forward, std::vector<glm::ivec3>& chunks);
+
+    [[nodiscard]] const visibility_stats& stats() const { return stats_; }
+private:
+    [[nodiscard]] face_connectivity connectivity(glm::ivec3 chunk) const;
+
+    std::unordered_map<glm::ivec3, face_connectivity, ivec3_hash> chunks_{};
+    std::optional<std::size_t> tracker_{};
+    std::vector<glm::ivec3> changed_{};
+    glm::ivec3 min_{};
+    glm::ivec3 max_{};
+
+    struct node {
+        glm::ivec3 chunk{};
+        std::int8_t entered{};
+        std::uint8_t directions{};
+    };
+
+    std::vector<node> queue_{};
+    std::vector<std::uint8_t> visited_{};
+    visibility_stats stats_{};
+};
+
+}
+
+#endif
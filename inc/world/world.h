@@ -0,0 +1,366 @@
+#ifndef JA_WORLD_H
+#define JA_WORLD_H
+
+#include <cstddef>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ranges>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+#include <world/aabb.h>
+#include <world/block.h>
+#include <world/chunk.h>
+
+namespace ja {
+
+inline constexpr int chunk_size{16};
+
+using world_chunk = chunk<chunk_size, chunk_size, chunk_size>;
+
+/**
+ * Hash function for integer vectors, such as chunk coordinates.
+ */
+struct ivec3_hash {
+    [[nodiscard]] std::size_t operator()(const glm::ivec3& v) const {
+        std::size_t hash = std::hash<int>{}(v.x);
+        hash = hash * 0x9e3779b97f4a7c15u ^ std::hash<int>{}(v.y);
+        hash = hash * 0x9e3779b97f4a7c15u ^ std::hash<int>{}(v.z);
+        return hash;
+    }
+};
+
+/**
+ * Division that rounds towards negative infinity.
+ */
+[[nodiscard]] constexpr int floor_div(int a, int b) {
+    return (a >= 0) ? a / b : (a - b + 1) / b;
+}
+
+/**
+ * Obtain the coordinates of the chunk that contains a block.
+ */
+[[nodiscard]] inline glm::ivec3 chunk_coord(glm::ivec3 block) {
+    return glm::ivec3{floor_div(block.x, chunk_size), floor_div(block.y, chunk_size), floor_div(block.z, chunk_size)};
+}
+
+/**
+ * Obtain the coordinates of a block relative to the chunk that contains it.
+ */
+[[nodiscard]] inline glm::ivec3 local_coord(glm::ivec3 block) {
+    return block - chunk_coord(block) * chunk_size;
+}
+
+/**
+ * Obtain the position of a block within the storage order of its chunk.
+ */
+[[nodiscard]] constexpr std::uint32_t local_index(glm::ivec3 local) {
+    return static_cast<std::uint32_t>((local.x * chunk_size + local.y) * chunk_size + local.z);
+}
+
+/**
+ * Obtain the coordinates of a block relative to its chunk from its position in storage order.
+ */
+[[nodiscard]] constexpr glm::ivec3 local_from_index(std::uint32_t index) {
+    const auto i = static_cast<int>(index);
+    return glm::ivec3{i / (chunk_size * chunk_size), i / chunk_size % chunk_size, i % chunk_size};
+}
+
+/**
+ * Obtain the coordinates of the block that contains a point.
+ *
+ * Blocks are unit cubes centered on their coordinates.
+ */
+[[nodiscard]] inline glm::ivec3 block_coord(glm::vec3 point) {
+    return glm::ivec3{glm::floor(point + 0.5f)};
+}
+
+/**
+ * Obtain the bounding box of a block.
+ */
+[[nodiscard]] inline aabb block_bounds(glm::ivec3 block) {
+    return aabb{glm::vec3{block} - 0.5f, glm::vec3{block} + 0.5f};
+}
+
+/**
+ * Obtain the bounding box of a chunk.
+ */
+[[nodiscard]] inline aabb chunk_bounds(glm::ivec3 chunk) {
+    const glm::vec3 min = glm::vec3{chunk * chunk_size} - 0.5f;
+    return aabb{min, min + static_cast<float>(chunk_size)};
+}
+
+/**
+ * The blocks of a chunk, shared between the world and its snapshots.
+ */
+struct shared_chunk {
+    shared_chunk() = default;
+    explicit shared_chunk(const world_chunk& blocks) : blocks{blocks} {}
+
+    world_chunk blocks{};
+
+    /**
+     * Number of snapshots that refer to the blocks.
+     */
+    mutable std::atomic<std::size_t> readers{};
+};
+
+/**
+ * An immutable view of the blocks of a chunk at some revision.
+ *
+ * Snapshots don't change when the world is edited afterwards, so they can
+ * be read from other threads while the world keeps changing.
+ */
+struct chunk_snapshot {
+    chunk_snapshot() = default;
+
+    chunk_snapshot(const chunk_snapshot& other)
+        : chunk_{other.chunk_}, revision_{other.revision_} {
+        if (chunk_) chunk_->readers.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    chunk_snapshot(chunk_snapshot&& other) noexcept
+        : chunk_{std::move(other.chunk_)}, revision_{other.revision_} {}
+
+    chunk_snapshot& operator=(chunk_snapshot other) noexcept {
+        std::swap(chunk_, other.chunk_);
+        std::swap(revision_, other.revision_);
+        return *this;
+    }
+
+    ~chunk_snapshot() {
+        // pairs with the acquire in world::writable, so reads of the blocks happen before later writes
+        if (chunk_) chunk_->readers.fetch_sub(1, std::memory_order_release);
+    }
+
+    [[nodiscard]] const world_chunk& operator*() const { return chunk_->blocks; }
+    [[nodiscard]] const world_chunk* operator->() const { return &chunk_->blocks; }
+    [[nodiscard]] const world_chunk* get() const { return chunk_ ? &chunk_->blocks : nullptr; }
+
+    /**
+     * Obtain the revision of the chunk the snapshot was taken at.
+     */
+    [[nodiscard]] std::uint64_t revision() const { return revision_; }
+
+    [[nodiscard]] explicit operator bool() const { return chunk_ != nullptr; }
+private:
+    friend struct world;
+
+    chunk_snapshot(std::shared_ptr<const shared_chunk> chunk, std::uint64_t revision)
+        : chunk_{std::move(chunk)}, revision_{revision} {
+        chunk_->readers.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::shared_ptr<const shared_chunk> chunk_{};
+    std::uint64_t revision_{};
+};
+
+struct edit_journal;
+
+struct decompression_stats {
+    std::size_t count{};
+    float total_ms{};
+    float max_ms{};
+
+    /**
+     * Number of chunks whose compressed form turned out to be corrupt.
+     */
+    std::size_t failures{};
+};
+
+/**
+ * An unbounded grid of chunks.
+ *
+ * Chunks are created on demand and every chunk has a revision that is bumped
+ * whenever its blocks change, so derived data (meshes, caches) can tell when
+ * it is stale. Reading and writing blocks of distinct chunks from multiple
+ * threads is fine, creating chunks is not.
+ *
+ * Chunks are copied on write: writing to a chunk of which a snapshot is
+ * still held first gives the world its own copy. Snapshots are taken on the
+ * thread that edits the world, but may be released on any thread.
+ *
+ * Chunks that haven't been used for a while can be stored compressed, see
+ * chunk_compressor. They are decompressed on the next access, which is safe
+ * from multiple threads. Dropping the blocks of a chunk in favor of its
+ * compressed form invalidates pointers to them. A chunk whose compressed
+ * form turns out to be corrupt keeps the blocks that could be decoded and
+ * stays marked as compressed until it is written to, which makes those
+ * blocks its own, see decompression_stats::failures.
+ */
+struct world {
+    /**
+     * Obtain the block at some coordinates, empty if its chunk doesn't exist.
+     */
+    [[nodiscard]] int get_block(glm::ivec3 pos) const;
+
+    /**
+     * Place a block, creating its chunk if needed.
+     *
+     * Blocks that actually change are recorded in the journal, if there is one.
+     */
+    void set_block(glm::ivec3 pos, int block);
+
+    /**
+     * Record the changes made through set_block, region edits and block ticks
+     * in a journal, or stop doing so with nullptr.
+     */
+    void set_journal(edit_journal* journal) { journal_ = journal; }
+    [[nodiscard]] edit_journal* journal() const { return journal_; }
+
+    /**
+     * Obtain a chunk by its coordinates, or nullptr if it doesn't exist.
+     *
+     * The mutable overload takes the chunk for writing: it copies the chunk if
+     * a snapshot of it is held and drops its compressed form, so reads should
+     * go through the const overload. The pointer must not be written through
+     * after taking another snapshot.
+     */
+    [[nodiscard]] world_chunk* find_chunk(glm::ivec3 chunk);
+    [[nodiscard]] const world_chunk* find_chunk(glm::ivec3 chunk) const;
+
+    /**
+     * Obtain a chunk by its coordinates, creating it if it doesn't exist.
+     *
+     * Like find_chunk, the chunk is copied if a snapshot of it is held.
+     */
+    world_chunk& chunk_at(glm::ivec3 chunk);
+
+    /**
+     * Take a snapshot of a chunk, which is empty if the chunk doesn't exist.
+     */
+    [[nodiscard]] chunk_snapshot snapshot(glm::ivec3 chunk) const;
+
+    /**
+     * Mark a chunk as changed after modifying its blocks directly.
+     */
+    void invalidate(glm::ivec3 chunk);
+
+    /**
+     * Obtain the revision of a chunk, which is bumped on every change.
+     *
+     * Chunks start at revision 1, missing chunks are at revision 0.
+     */
+    [[nodiscard]] std::uint64_t revision(glm::ivec3 chunk) const;
+
+    /**
+     * Obtain the coordinates of all chunks.
+     */
+    [[nodiscard]] auto chunks() const {
+        return std::views::keys(chunks_);
+    }
+
+    [[nodiscard]] std::size_t chunk_count() const { return chunks_.size(); }
+
+    /**
+     * Start collecting the chunks that are created or change, so derived data
+     * can be brought up to date without looking at every chunk.
+     *
+     * @return Id to pass to take_changes, for which every existing chunk counts as changed.
+     */
+    [[nodiscard]] std::size_t track_changes() const;
+
+    /**
+     * Obtain the chunks that were created or changed since the previous call
+     * for the same id, each once and in no particular order.
+     *
+     * Like snapshots, this is called on the thread that edits the world.
+     */
+    void take_changes(std::size_t tracker, std::vector<glm::ivec3>& chunks) const;
+
+    /**
+     * Obtain the number of chunks that were copied because a snapshot of them was held.
+     */
+    [[nodiscard]] std::size_t copy_count() const { return copies_.load(std::memory_order_relaxed); }
+
+    /**
+     * Whether the blocks of a chunk are only held in compressed form.
+     */
+    [[nodiscard]] bool compressed(glm::ivec3 chunk) const;
+
+    /**
+     * Obtain the size of the compressed form of a chunk, 0 if it has none.
+     */
+    [[nodiscard]] std::size_t compressed_bytes(glm::ivec3 chunk) const;
+
+    /**
+     * Check whether a chunk was accessed since the previous call, and reset that.
+     */
+    [[nodiscard]] bool take_accessed(glm::ivec3 chunk);
+
+    /**
+     * Replace the blocks of a chunk with their compressed form.
+     *
+     * @param revision Revision the blocks were compressed at, nothing
+     *                 happens if the chunk changed since.
+     * @return Whether the blocks were dropped.
+     */
+    bool store_compressed(glm::ivec3 chunk, std::uint64_t revision, std::vector<std::uint8_t> data);
+
+    /**
+     * Drop the blocks of a chunk if its compressed form is still up to date.
+     *
+     * @return Whether the blocks were dropped.
+     */
+    bool release(glm::ivec3 chunk);
+
+    [[nodiscard]] decompression_stats decompression() const;
+private:
+    struct entry {
+        // only replaced when the chunk is written to, which nothing else
+        // does at the same time, or during decompression before resident is set
+        mutable std::shared_ptr<shared_chunk> chunk{};
+        std::uint64_t revision{};
+
+        std::vector<std::uint8_t> compressed{};
+        std::uint64_t compressed_revision{};
+
+        mutable std::atomic<bool> resident{};
+        mutable std::atomic<bool> accessed{};
+
+        // set under the decompression mutex when the compressed form can't be
+        // decoded, and cleared there again when the chunk is written to
+        mutable bool corrupt{};
+
+        /**
+         * Trackers that were told about the latest change, one bit each.
+         */
+        mutable std::atomic<std::uint32_t> reported{};
+    };
+
+    inline static constexpr std::size_t max_trackers{32};
+
+    /**
+     * Obtain the blocks of a chunk, decompressing them if needed.
+     */
+    shared_chunk& load(const entry& entry) const;
+
+    /**
+     * Make sure no snapshot refers to the chunk of an entry before it is written to.
+     */
+    world_chunk& writable(entry& entry);
+
+    /**
+     * Tell the trackers that a chunk changed, unless they already know.
+     */
+    void report(glm::ivec3 chunk, const entry& entry) const;
+
+    std::unordered_map<glm::ivec3, entry, ivec3_hash> chunks_{};
+    std::atomic<std::size_t> copies_{};
+    edit_journal* journal_{};
+
+    mutable std::mutex decompress_mutex_{};
+    mutable decompression_stats decompression_{};
+
+    mutable std::mutex changes_mutex_{};
+    mutable std::vector<std::vector<glm::ivec3>> changes_{};
+    mutable std::atomic<std::uint32_t> trackers_{};
+};
+
+}
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef JA_WORLD_EDIT_H
+#define JA_WORLD_EDIT_H
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include <utility/thread_pool.h>
+#include <world/block.h>
+#include <world/world.h>
+
+namespace ja {
+
+/**
+ * A copy of a box of blocks, stored in the same order as chunks.
+ */
+struct clipboard {
+    glm::ivec3 size{};
+    std::vector<int> blocks{};
+
+    [[nodiscard]] int operator[](int x, int y, int z) const {
+        return blocks[static_cast<std::size_t>((x * size.y + y) * size.z + z)];
+    }
+
+    /**
+     * Obtain a copy rotated around the vertical axis.
+     *
+     * @param quarter_turns Number of counterclockwise quarter turns, seen from above.
+     */
+    [[nodiscard]] clipboard rotated(int quarter_turns) const;
+};
+
+struct edit_stats {
+    /**
+     * Number of chunks and blocks that changed.
+     */
+    std::size_t chunks{};
+    std::size_t blocks{};
+
+    float ms{};
+};
+
+/*
+ * Region operations split their region by chunk and process the chunks in
+ * parallel, a row of blocks at a time. Every chunk that changed is
+ * invalidated once afterwards, so it's remeshed once, and if the world has
+ * a journal the edits are recorded as a single operation.
+ *
+ * Regions are given by their first and last block, both inclusive.
+ */
+
+/**
+ * Fill a box with a block.
+ */
+edit_stats fill_box(world& world, thread_pool& pool, glm::ivec3 min, glm::ivec3 max, int block);
+
+/**
+ * Fill the blocks whose centers lie within a sphere with a block.
+ */
+edit_stats fill_sphere(world& world, thread_pool& pool, glm::ivec3 center, float radius, int block);
+
+/**
+ * Replace every block of one kind within a box by another.
+ */
+edit_stats replace_blocks(world& world, thread_pool& pool, glm::ivec3 min, glm::ivec3 max, int from, int to);
+
+/**
+ * Copy the blocks within a box.
+ */
+[[nodiscard]] clipboard copy_region(const world& world, thread_pool& pool, glm::ivec3 min, glm::ivec3 max);
+
+/**
+ * Place copied blocks with their first block at some position.
+ *
+ * @param include_empty Whether empty blocks replace the blocks they're pasted over.
+ */
+edit_stats paste(world& world, thread_pool& pool, const clipboard& clipboard, glm::ivec3 origin, bool include_empty = false);
+
+/**
+ * Write copied blocks to a schematic file.
+ *
+ * Schematics start with "JASC", a version and the size as 32-bit integers,
+ * followed by the blocks as written by compress_blocks.
+ *
+ * @return Whether the file could be written.
+ */
+bool save_schematic(const std::string& path, const clipboard& clipboard);
+
+/**
+ * Read a schematic file, to paste its blocks.
+ */
+[[nodiscard]] std::optional<clipboard> load_schematic(const std::string& path);
+
+}
+
+#endif
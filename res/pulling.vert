@@ -0,0 +1,42 @@
+#version 430 core
+
+// one packed record per visible face, see ja::pack_face
+layout (std430, binding = 0) readonly buffer faces_ {
+    uint faces[];
+};
+
+out vec3 texcoord;
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 proj;
+
+// must match ja::cube_face_indices
+const uint face_indices[6] = uint[](0, 1, 2, 0, 2, 3);
+
+// must match ja::cube_face_vertices, four corners per face in the order of ja::cube_face
+const vec3 corners[24] = vec3[](
+    vec3(-0.5, -0.5,  0.5), vec3(-0.5,  0.5,  0.5), vec3( 0.5,  0.5,  0.5), vec3( 0.5, -0.5,  0.5),
+    vec3( 0.5, -0.5, -0.5), vec3( 0.5,  0.5, -0.5), vec3(-0.5,  0.5, -0.5), vec3(-0.5, -0.5, -0.5),
+    vec3(-0.5, -0.5, -0.5), vec3(-0.5,  0.5, -0.5), vec3(-0.5,  0.5,  0.5), vec3(-0.5, -0.5,  0.5),
+    vec3( 0.5, -0.5,  0.5), vec3( 0.5,  0.5,  0.5), vec3( 0.5,  0.5, -0.5), vec3( 0.5, -0.5, -0.5),
+    vec3(-0.5,  0.5,  0.5), vec3(-0.5,  0.5, -0.5), vec3( 0.5,  0.5, -0.5), vec3( 0.5,  0.5,  0.5),
+    vec3( 0.5, -0.5,  0.5), vec3( 0.5, -0.5, -0.5), vec3(-0.5, -0.5, -0.5), vec3(-0.5, -0.5,  0.5)
+);
+
+const vec2 texcoords[24] = vec2[](
+    vec2(0.0, 0.0), vec2(0.0, 1.0), vec2(1.0, 1.0), vec2(1.0, 0.0),
+    vec2(1.0, 0.0), vec2(1.0, 1.0), vec2(0.0, 1.0), vec2(0.0, 0.0),
+    vec2(0.0, 0.0), vec2(0.0, 1.0), vec2(1.0, 1.0), vec2(1.0, 0.0),
+    vec2(1.0, 0.0), vec2(1.0, 1.0), vec2(0.0, 1.0), vec2(0.0, 0.0),
+    vec2(0.0, 0.0), vec2(0.0, 1.0), vec2(1.0, 1.0), vec2(1.0, 0.0),
+    vec2(1.0, 0.0), vec2(1.0, 1.0), vec2(0.0, 1.0), vec2(0.0, 0.0)
+);
+
+void main() {
+    uint face = faces[gl_VertexID / 6];
+    uint corner = (face >> 15 & 7u) * 4u + face_indices[gl_VertexID % 6];
+
+    vec3 pos = vec3(face & 31u, face >> 5 & 31u, face >> 10 & 31u) + corners[corner];
+    texcoord = vec3(texcoords[corner], float(face >> 18 & 255u));
+    gl_Position = proj * view * model * vec4(pos, 1.0);
+}
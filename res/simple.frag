@@ -3,9 +3,11 @@
 in vec3 texcoord;
 out vec4 color;
 uniform sampler2DArray textures;
+uniform float alpha = 1.0;
 
 void main() {
     // color = vec4(1.0f, 0.5f, 0.2f, 1.0f);
     color = texture(textures, texcoord);
+    color.a *= alpha;
 }
 
@@ -0,0 +1,92 @@
+#include <input/input.h>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+
+namespace ja {
+
+namespace {
+
+constexpr std::array<char, 4> magic{'J', 'A', 'I', 'N'};
+constexpr std::uint32_t version{2};
+
+/**
+ * On-disk layout of a frame: timestamp in microseconds, key bits and cursor delta.
+ *
+ * The timestamp takes 64 bits, as 32 bits of microseconds only last 71 minutes.
+ */
+constexpr std::size_t record_size{sizeof(std::uint64_t) + sizeof(std::uint8_t) + 2 * sizeof(float)};
+
+static_assert(std::endian::native == std::endian::little, "recordings are stored in little-endian byte order");
+
+template<typename T>
+void write(std::ostream& os, T value) {
+    auto bytes = std::bit_cast<std::array<char, sizeof(T)>>(value);
+    os.write(bytes.data(), bytes.size());
+}
+
+template<typename T>
+T read(const char* data) {
+    std::array<char, sizeof(T)> bytes{};
+    std::memcpy(bytes.data(), data, sizeof(T));
+    return std::bit_cast<T>(bytes);
+}
+
+}
+
+input_recorder::input_recorder(const std::string& path)
+    :ofs_{path, std::ios::binary} {
+    ofs_.write(magic.data(), magic.size());
+    write(ofs_, version);
+}
+
+void input_recorder::record(const input_frame& frame) {
+    write(ofs_, static_cast<std::uint64_t>(std::llround(frame.time * 1'000'000.0)));
+    write(ofs_, frame.keys);
+    write(ofs_, frame.cursor_delta.x);
+    write(ofs_, frame.cursor_delta.y);
+}
+
+input_player::input_player(const std::string& path, double timestep)
+    :timestep_{timestep} {
+    std::ifstream ifs{path, std::ios::binary};
+    if (!ifs) return;
+
+    std::array<char, magic.size() + sizeof(version)> header{};
+    if (!ifs.read(header.data(), header.size())) return;
+    if (!std::equal(magic.begin(), magic.end(), header.begin())) return;
+    if (read<std::uint32_t>(header.data() + magic.size()) != version) return;
+
+    std::array<char, record_size> record{};
+    while (ifs.read(record.data(), record.size())) {
+        const char* data = record.data();
+        input_frame frame{};
+        frame.time = static_cast<double>(read<std::uint64_t>(data)) / 1'000'000.0;
+        data += sizeof(std::uint64_t);
+        frame.keys = read<std::uint8_t>(data);
+        data += sizeof(std::uint8_t);
+        frame.cursor_delta.x = read<float>(data);
+        data += sizeof(float);
+        frame.cursor_delta.y = read<float>(data);
+        frames_.push_back(frame);
+    }
+
+    loaded_ = true;
+}
+
+input_frame input_player::next() {
+    time_ += timestep_;
+
+    input_frame frame{.time = time_};
+    for (; cursor_ < frames_.size() && frames_[cursor_].time <= time_; ++cursor_) {
+        keys_ = frames_[cursor_].keys;
+        frame.cursor_delta += frames_[cursor_].cursor_delta;
+    }
+    frame.keys = keys_;
+
+    return frame;
+}
+
+}
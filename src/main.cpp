@@ -1,6 +1,21 @@
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <format>
 #include <memory>
+#include <optional>
 #include <print>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 #include <glad/gl.h>
 #include <GLFW/glfw3.h>
 #include <glm/ext/matrix_clip_space.hpp>
@@ -13,12 +28,31 @@
 #include <graphics/shader.h>
 #include <graphics/texture.h>
 #include <graphics/vertex_array.h>
+#include <input/input.h>
+#include <network/replication.h>
+#include <network/socket.h>
 #include <ranges>
 #include <utility/angle.h>
+#include <utility/fixed_timestep.h>
 #include <utility/scope_guard.h>
+#include <utility/thread_pool.h>
+#include <world/benchmarks.h>
+#include <world/block_behaviors.h>
 #include <world/frustrum.h>
 #include <world/chunk.h>
+#include <world/chunk_compressor.h>
+#include <world/chunk_mesh.h>
+#include <world/collision.h>
 #include <world/cube.h>
+#include <world/face_mesh.h>
+#include <world/fluid.h>
+#include <world/fluid_mesh.h>
+#include <world/occlusion.h>
+#include <world/terrain.h>
+#include <world/tick_scheduler.h>
+#include <world/visibility.h>
+#include <world/world.h>
+#include <world/world_edit.h>
 
 struct {
     glm::vec3 pos{};
@@ -26,28 +60,266 @@ struct {
     glm::vec3 up{0.0f, 1.0f, 0.0f};
 } camera{};
 
+glm::vec2 cursor_delta{};
+
 void cursor_pos_callback([[maybe_unused]] GLFWwindow* window, double x, double y) {
-    constexpr float sensitivity{0.2f};
     static glm::dvec2 old{x, y};
+    cursor_delta += glm::vec2{x - old.x, y - old.y};
+    old = {x, y};
+}
+
+/**
+ * Poll the current key state and the cursor movement since the previous frame.
+ */
+ja::input_frame poll_input(GLFWwindow* window, double time) {
+    constexpr std::array bindings{
+        std::pair{GLFW_KEY_W, ja::input_key::forward},
+        std::pair{GLFW_KEY_S, ja::input_key::backward},
+        std::pair{GLFW_KEY_A, ja::input_key::left},
+        std::pair{GLFW_KEY_D, ja::input_key::right},
+        std::pair{GLFW_KEY_SPACE, ja::input_key::up},
+        std::pair{GLFW_KEY_LEFT_SHIFT, ja::input_key::down},
+    };
 
-    auto yaw = ja::degrees<float>((old.x - x) * sensitivity);
-    auto pitch = ja::degrees<float>(-(y - old.y) * sensitivity);
+    ja::input_frame frame{.time = time, .cursor_delta = std::exchange(cursor_delta, {})};
+    for (auto [key, input] : bindings) {
+        if (glfwGetKey(window, key) == GLFW_PRESS) {
+            frame.press(input);
+        }
+    }
+    return frame;
+}
+
+/**
+ * Rotate the camera according to a frame of input and obtain the velocity it should move at.
+ */
+glm::vec3 update_camera(const ja::input_frame& frame) {
+    constexpr float sensitivity{0.2f};
+    constexpr float speed{2.0f};
+
+    auto yaw = ja::degrees<float>(-frame.cursor_delta.x * sensitivity);
+    auto pitch = ja::degrees<float>(-frame.cursor_delta.y * sensitivity);
 
     auto rot = glm::rotate(glm::mat4{1.0f}, yaw.radians(), glm::vec3{0.0f, 1.0f, 0.0f});
     rot = glm::rotate(rot, pitch.radians(), glm::normalize(glm::cross(camera.forward, camera.up)));
     camera.forward = glm::normalize(glm::vec3{rot * glm::vec4{camera.forward, 0.0f}});
     camera.up = glm::normalize(glm::vec3{rot * glm::vec4{camera.up, 0.0f}});
 
-    old = {x, y};
+    glm::vec3 input{};
+    if (frame.pressed(ja::input_key::forward)) {
+        input += glm::vec3{0.0f, 0.0f, 1.0f};
+    }
+
+    if (frame.pressed(ja::input_key::backward)) {
+        input += glm::vec3{0.0f, 0.0f, -1.0f};
+    }
+
+    if (frame.pressed(ja::input_key::left)) {
+        input += glm::vec3{1.0f, 0.0f, 0.0f};
+    }
+
+    if (frame.pressed(ja::input_key::right)) {
+        input += glm::vec3{-1.0f, 0.0f, 0.0f};
+    }
+
+    if (frame.pressed(ja::input_key::down)) {
+        input += glm::vec3{0.0f, -1.0f, 0.0f};
+    }
+
+    if (frame.pressed(ja::input_key::up)) {
+        input += glm::vec3{0.0f, 1.0f, 0.0f};
+    }
+
+    glm::vec3 velocity{};
+    if (glm::length(input) > 0.0f) {
+        glm::vec3 forward = glm::normalize(glm::vec3{camera.forward.x, 0.0f, camera.forward.z});
+        glm::vec3 right = glm::normalize(glm::cross(camera.up, camera.forward));
+        velocity += forward * speed * glm::normalize(input).z;
+        velocity += right * speed * glm::normalize(input).x;
+        velocity.y += speed * glm::normalize(input).y;
+    }
+    return velocity;
 }
 
-int main() {
+/**
+ * Bounds of the player relative to the camera.
+ */
+constexpr glm::vec3 player_half_size{0.3f, 0.9f, 0.3f};
+constexpr float eye_height{0.7f};
+
+/**
+ * Everything the renderer keeps per chunk of the world.
+ */
+struct render_chunk {
+    glm::ivec3 coord{};
+    ja::chunk_mesh mesh{};
+    ja::chunk_face_mesh faces{};
+    std::vector<ja::occluder> occluders{};
+    std::uint64_t revision{};
+
+    /**
+     * Translucent faces of the fluid, which are reordered when the camera moves to another block.
+     */
+    ja::chunk_mesh fluid{};
+    std::vector<ja::cube_vertex> fluid_vertices{};
+    std::vector<unsigned int> fluid_indices{};
+    std::uint64_t fluid_revision{};
+    glm::ivec3 sorted_from{};
+};
+
+/**
+ * Command line options.
+ *
+ * --record <path>  write the input of this session to a file
+ * --replay <path>  replay a recorded session with a fixed timestep and exit
+ * --headless       do not show the window
+ * --renderer <name> "indexed" for indexed quads (default), "pulling" for
+ *                   vertex pulling from a buffer of packed faces (OpenGL 4.3)
+ * --entities <n>    simulate n falling boxes on the terrain
+ * --compress-after <seconds> compress chunks that weren't used for this long (default 10)
+ * --journal-benchmark compare saving edits through the journal with saving whole chunks, and exit
+ * --edit-benchmark  time region edits on a 512^3 box, and exit
+ * --tick-benchmark  time block ticks with 10k active chunks, and exit
+ * --fluid-benchmark time fluid flooding generated terrain, and exit
+ * --nav-benchmark   time pathfinding for thousands of agents on generated terrain, and exit
+ * --snapshot-stress hold chunk snapshots on other threads while editing the chunks, check them, and exit
+ * --connect <address> play in the world of a dedicated server instead of a generated one
+ */
+enum class render_path {
+    indexed,
+    pulling,
+};
+
+struct options {
+    std::string record_path{};
+    std::string replay_path{};
+    bool headless{};
+    render_path renderer{render_path::indexed};
+    std::size_t entities{};
+    double compress_after{10.0};
+    bool journal_benchmark{};
+    bool edit_benchmark{};
+    bool tick_benchmark{};
+    bool fluid_benchmark{};
+    bool nav_benchmark{};
+    bool snapshot_stress{};
+    std::string connect_address{};
+};
+
+std::optional<options> parse_options(std::span<char*> args) {
+    options result{};
+    for (auto it = args.begin(); it != args.end(); ++it) {
+        const std::string_view arg{*it};
+        if (arg == "--headless") {
+            result.headless = true;
+        } else if (arg == "--journal-benchmark") {
+            result.journal_benchmark = true;
+        } else if (arg == "--edit-benchmark") {
+            result.edit_benchmark = true;
+        } else if (arg == "--tick-benchmark") {
+            result.tick_benchmark = true;
+        } else if (arg == "--fluid-benchmark") {
+            result.fluid_benchmark = true;
+        } else if (arg == "--nav-benchmark") {
+            result.nav_benchmark = true;
+        } else if (arg == "--snapshot-stress") {
+            result.snapshot_stress = true;
+        } else if (arg == "--record" && std::next(it) != args.end()) {
+            result.record_path = *++it;
+        } else if (arg == "--replay" && std::next(it) != args.end()) {
+            result.replay_path = *++it;
+        } else if (arg == "--connect" && std::next(it) != args.end()) {
+            result.connect_address = *++it;
+        } else if (arg == "--entities" && std::next(it) != args.end()) {
+            const std::string_view count{*++it};
+            if (std::from_chars(count.data(), count.data() + count.size(), result.entities).ec != std::errc{}) {
+                std::println(stderr, "invalid entity count: {}", count);
+                return std::nullopt;
+            }
+        } else if (arg == "--compress-after" && std::next(it) != args.end()) {
+            const std::string_view seconds{*++it};
+            if (std::from_chars(seconds.data(), seconds.data() + seconds.size(), result.compress_after).ec != std::errc{}) {
+                std::println(stderr, "invalid compression delay: {}", seconds);
+                return std::nullopt;
+            }
+        } else if (arg == "--renderer" && std::next(it) != args.end()) {
+            const std::string_view name{*++it};
+            if (name == "indexed") {
+                result.renderer = render_path::indexed;
+            } else if (name == "pulling") {
+                result.renderer = render_path::pulling;
+            } else {
+                std::println(stderr, "unknown renderer: {}", name);
+                return std::nullopt;
+            }
+        } else {
+            std::println(stderr, "unknown option: {}", arg);
+            return std::nullopt;
+        }
+    }
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    auto options = parse_options(std::span{argv, static_cast<std::size_t>(argc)}.subspan(1));
+    if (!options) return EXIT_FAILURE;
+
+    if (options->journal_benchmark) {
+        ja::run_journal_benchmark();
+        return EXIT_SUCCESS;
+    }
+
+    if (options->edit_benchmark) {
+        ja::run_edit_benchmark();
+        return EXIT_SUCCESS;
+    }
+
+    if (options->tick_benchmark) {
+        ja::run_tick_benchmark();
+        return EXIT_SUCCESS;
+    }
+
+    if (options->fluid_benchmark) {
+        ja::run_fluid_benchmark();
+        return EXIT_SUCCESS;
+    }
+
+    if (options->nav_benchmark) {
+        ja::run_nav_benchmark();
+        return EXIT_SUCCESS;
+    }
+
+    if (options->snapshot_stress) {
+        return ja::run_snapshot_stress() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    std::optional<ja::input_player> player{};
+    if (!options->replay_path.empty()) {
+        player.emplace(options->replay_path);
+        if (!*player) {
+            std::println(stderr, "failed to load recording: {}", options->replay_path);
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::optional<ja::input_recorder> recorder{};
+    if (!options->record_path.empty()) {
+        recorder.emplace(options->record_path);
+        if (!*recorder) {
+            std::println(stderr, "failed to open recording: {}", options->record_path);
+            return EXIT_FAILURE;
+        }
+    }
+
     if (!glfwInit()) return EXIT_FAILURE;
     ja::scope_guard _{glfwTerminate};
 
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    // shader storage buffers need OpenGL 4.3
+    const bool pulling = options->renderer == render_path::pulling;
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, pulling ? 4 : 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, options->headless ? GLFW_FALSE : GLFW_TRUE);
 
     struct window_deleter {
         void operator()(GLFWwindow* window) const {
@@ -73,19 +345,19 @@ int main() {
     glfwFocusWindow(window.get());
 
     gladLoadGL(glfwGetProcAddress);
-    glfwSwapInterval(1);
 
-    const auto vertices = ja::cube_vertices() | std::ranges::to<std::vector>();
-    using vertex_type = std::ranges::range_value_t<decltype(vertices)>;
+    // replays are benchmarks, so don't wait for vertical sync
+    glfwSwapInterval(player ? 0 : 1);
 
-    const auto indices = ja::cube_indices() | std::ranges::to<std::vector>();
-    using index_type = std::ranges::range_value_t<decltype(indices)>;
-
-    auto vertex_shader = ja::make_shader_from_file(GL_VERTEX_SHADER, "res/simple.vert");
+    auto vertex_shader = ja::make_shader_from_file(GL_VERTEX_SHADER, pulling ? "res/pulling.vert" : "res/simple.vert");
 
     auto fragment_shader = ja::make_shader_from_file(GL_FRAGMENT_SHADER, "res/simple.frag");
 
     auto program = ja::make_program(vertex_shader, fragment_shader);
+
+    // fluids are always drawn as indexed triangles, blended over everything else
+    auto fluid_program = ja::make_program(ja::make_shader_from_file(GL_VERTEX_SHADER, "res/simple.vert"), fragment_shader);
+
     glUseProgram(program.get());
 
     auto texture = ja::make_texture_atlas_from_file(5, 5, "res/texture-atlas.png");
@@ -94,31 +366,34 @@ int main() {
     glBindTexture(GL_TEXTURE_2D_ARRAY, texture.get());
     glUniform1i(glGetUniformLocation(program.get(), "texture"), 0);
 
-    auto vao = ja::make_vertex_array();
-    glBindVertexArray(vao.get());
-
-    auto vbo = ja::make_buffer();
-    glBindBuffer(GL_ARRAY_BUFFER, vbo.get());
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(vertex_type), vertices.data(), GL_STATIC_DRAW);
-
-    auto ebo = ja::make_buffer();
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo.get());
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(index_type), indices.data(), GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(vertex_type), nullptr);
-    glEnableVertexAttribArray(0);
+    ja::frustrum frustrum{};
 
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(vertex_type), reinterpret_cast<void*>(offsetof(vertex_type, texcoord)));
-    glEnableVertexAttribArray(1);
+    const auto proj = glm::perspective(frustrum.fov.radians(), 640.0f / 480.0f, frustrum.near, frustrum.far);
+    for (const auto& target : {program.get(), fluid_program.get()}) {
+        glUseProgram(target);
+        int location = glGetUniformLocation(target, "proj");
+        glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(proj));
+    }
+    glUseProgram(program.get());
 
-    camera.pos = glm::vec3{0.0f, 0.0f, -3.0f};
+    ja::thread_pool pool{};
+    ja::world world{};
 
-    ja::frustrum frustrum{};
+    // a server sends the chunks around the camera instead
+    std::optional<ja::replication_client> server{};
+    if (!options->connect_address.empty()) {
+        auto socket = ja::connect_to(options->connect_address);
+        if (!socket) {
+            std::println(stderr, "failed to connect to {}: {}", options->connect_address, std::strerror(errno));
+            return EXIT_FAILURE;
+        }
+        server.emplace(std::move(*socket));
+    }
+    constexpr int server_view_radius{4};
 
-    {
-        auto proj = glm::perspective(frustrum.fov.radians(), 640.0f / 480.0f, frustrum.near, frustrum.far);
-        int location = glGetUniformLocation(program.get(), "proj");
-        glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(proj));
+    const ja::terrain_params terrain{};
+    if (!server) {
+        ja::generate_terrain(world, glm::ivec3{-4, 0, -4}, glm::ivec3{4, 3, 4}, pool, terrain);
     }
 
     ja::chunk<8, 4, 7> chunk{};
@@ -158,80 +433,421 @@ int main() {
     chunk[3, 1, 1] = empty;
     chunk[3, 2, 1] = empty;
 
-    chunk.rebuild();
-    glBindVertexArray(chunk.vertex_array());
+    // put the house on the terrain, clearing the space around it
+    const glm::ivec3 house_origin{0, ja::terrain_height(0, 0, terrain), 0};
+    const ja::clipboard house{
+        glm::ivec3{chunk.width, chunk.height, chunk.depth},
+        chunk.blocks() | std::ranges::to<std::vector>(),
+    };
+    if (!server) {
+        ja::paste(world, pool, house, house_origin, true);
+    }
+
+    // a spring on the hill behind the house, unless the blocks come from a server
+    ja::fixed_timestep fluid_clock{1.0 / 8.0};
+    ja::fluid_simulation fluids{};
+    if (!server) {
+        const glm::ivec3 spring{-6, 0, 12};
+        fluids.add_source(world, glm::ivec3{spring.x, ja::terrain_height(spring.x, spring.z, terrain) + 2, spring.z});
+    }
+    double total_fluid_ms{};
+    std::size_t fluid_steps{};
+    std::size_t fluid_updates{};
+
+    camera.pos = glm::vec3{house_origin} + glm::vec3{3.5f, 2.0f, -3.0f};
+
+    const glm::vec3 player_center = camera.pos - glm::vec3{0.0f, eye_height, 0.0f};
+    ja::aabb player_bounds{player_center - player_half_size, player_center + player_half_size};
+
+    ja::fixed_timestep physics_clock{1.0 / 60.0};
+    ja::physics_world physics{};
+
+    // boxes dropped at random places above the terrain
+    {
+        std::mt19937 random{42};
+        std::uniform_real_distribution<float> horizontal{-4.0f * ja::chunk_size, 4.0f * ja::chunk_size};
+        std::uniform_real_distribution<float> speed{-3.0f, 3.0f};
+        constexpr glm::vec3 half_size{0.4f};
+
+        for (std::size_t i = 0; i < options->entities; ++i) {
+            const float x = horizontal(random);
+            const float z = horizontal(random);
+            const int height = ja::terrain_height(static_cast<int>(x), static_cast<int>(z), terrain);
+            const glm::vec3 center{x, height + 8.0f, z};
+            physics.add(ja::body{
+                .box = ja::aabb{center - half_size, center + half_size},
+                .velocity = glm::vec3{speed(random), 0.0f, speed(random)},
+            });
+        }
+    }
+
+    double total_physics_ms{};
+    std::size_t physics_steps{};
+
+    ja::fixed_timestep tick_clock{1.0 / 20.0};
+    ja::tick_scheduler ticks{};
+    ja::add_grass_spread(ticks);
+    double total_tick_ms{};
+    std::size_t tick_count{};
+
+    std::vector<render_chunk> render_chunks{};
+    std::unordered_map<glm::ivec3, std::size_t, ja::ivec3_hash> render_chunk_indices{};
+    render_chunks.reserve(world.chunk_count());
+    for (auto coord : world.chunks()) {
+        render_chunk_indices[coord] = render_chunks.size();
+        render_chunks.emplace_back().coord = coord;
+    }
+
+    ja::chunk_mesher mesher{pool};
+    std::vector<render_chunk*> stale{};
+    std::vector<ja::chunk_snapshot> stale_snapshots{};
+    std::vector<const ja::world_chunk*> stale_chunks{};
+    std::vector<ja::mesh_data> stale_meshes{};
+    std::vector<std::span<std::uint32_t>> stale_faces{};
+
+    // vertex pulling doesn't use any attributes, but drawing requires a vertex array
+    auto pulling_vao = ja::make_vertex_array();
+
+    ja::visibility_graph visibility{};
+    std::vector<glm::ivec3> reachable{};
+
+    ja::chunk_compressor compressor{options->compress_after};
+
+    ja::occlusion_culler culler{};
+
+    // only the chunks nearest to the camera contribute occluders
+    constexpr std::size_t occluder_chunk_count{64};
+
+    std::vector<const render_chunk*> occluder_chunks{};
+    std::vector<std::size_t> candidates{};
+    std::vector<ja::aabb> bounds{};
+    std::vector<std::uint8_t> visible{};
+    std::vector<render_chunk*> translucent{};
+    ja::scratch_arena sort_arena{};
+
+    std::size_t total_reachable{};
+    double total_visibility_ms{};
+    std::size_t total_culled{};
+    double total_occlusion_ms{};
+    double title_time{};
+
+    // compare the geometry both render paths would upload for this world
+    if (player) {
+        ja::scratch_arena arena{};
+        std::size_t indexed_bytes{};
+        std::size_t pulling_bytes{};
+        for (auto coord : world.chunks()) {
+            const auto& chunk = *std::as_const(world).find_chunk(coord);
+            arena.reset();
+            const auto mesh = ja::make_chunk_mesh(chunk, arena);
+            indexed_bytes += mesh.vertices.size_bytes() + mesh.indices.size_bytes();
+            pulling_bytes += ja::make_chunk_faces(chunk, arena).size_bytes();
+        }
+
+        constexpr double mebibyte{1024.0 * 1024.0};
+        std::println("geometry: indexed {:.2f} MiB, vertex pulling {:.2f} MiB ({:.1f}x less)",
+            indexed_bytes / mebibyte, pulling_bytes / mebibyte, static_cast<double>(indexed_bytes) / pulling_bytes);
+
+        ja::report_storage(world);
+    }
 
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_TEXTURE_2D_ARRAY);
 
-    double prev_time = glfwGetTime();
+    const double start_time = glfwGetTime();
+    double prev_time = start_time;
+    std::size_t frame_count{};
 
     while (!glfwWindowShouldClose(window.get())) {
         glClearColor(0, 156.0 / 255.0, 130 / 255.0, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        const float curr_time = glfwGetTime();
-        const float delta_time = curr_time - prev_time;
-        prev_time = curr_time;
-
-        constexpr float speed{2.0f};
-
         // handle input
         if (glfwGetKey(window.get(), GLFW_KEY_ESCAPE) == GLFW_PRESS) {
             glfwSetWindowShouldClose(window.get(), true);
         }
 
-        glm::vec3 input{};
-        if (glfwGetKey(window.get(), GLFW_KEY_W) == GLFW_PRESS) {
-            input += glm::vec3{0.0f, 0.0f, 1.0f};
+        ja::input_frame input{};
+        float delta_time{};
+
+        if (player) {
+            if (player->done()) break;
+            input = player->next();
+            delta_time = player->timestep();
+        } else {
+            const double curr_time = glfwGetTime();
+            delta_time = curr_time - prev_time;
+            prev_time = curr_time;
+
+            input = poll_input(window.get(), curr_time - start_time);
+            if (recorder) {
+                recorder->record(input);
+            }
         }
 
-        if (glfwGetKey(window.get(), GLFW_KEY_S) == GLFW_PRESS) {
-            input += glm::vec3{0.0f, 0.0f, -1.0f};
+        const glm::vec3 velocity = update_camera(input);
+
+        for (int step = physics_clock.advance(delta_time); step > 0; --step) {
+            const auto step_time = static_cast<float>(physics_clock.step());
+            ja::move_and_collide(world, player_bounds, velocity * step_time);
+
+            if (!physics.bodies().empty()) {
+                physics.step(world, step_time, pool);
+                total_physics_ms += physics.stats().step_ms;
+                ++physics_steps;
+            }
         }
 
-        if (glfwGetKey(window.get(), GLFW_KEY_A) == GLFW_PRESS) {
-            input += glm::vec3{1.0f, 0.0f, 0.0f};
+        camera.pos = player_bounds.center() + glm::vec3{0.0f, eye_height, 0.0f};
+
+        if (server) {
+            // blocks only change on the server, and chunks appear as they come into view
+            server->set_view(ja::block_coord(camera.pos), server_view_radius);
+            if (!server->update(&world)) {
+                std::println(stderr, "lost the connection to {}", options->connect_address);
+                break;
+            }
+
+            if (render_chunks.size() != world.chunk_count()) {
+                for (auto coord : world.chunks()) {
+                    if (render_chunk_indices.try_emplace(coord, render_chunks.size()).second) {
+                        render_chunks.emplace_back().coord = coord;
+                    }
+                }
+            }
+        } else {
+            for (int step = tick_clock.advance(delta_time); step > 0; --step) {
+                ticks.tick(world, pool);
+                total_tick_ms += ticks.stats().ms;
+                ++tick_count;
+            }
+
+            for (int step = fluid_clock.advance(delta_time); step > 0; --step) {
+                fluids.step(world, pool);
+                total_fluid_ms += fluids.stats().ms;
+                fluid_updates += fluids.stats().updated;
+                ++fluid_steps;
+            }
         }
 
-        if (glfwGetKey(window.get(), GLFW_KEY_D) == GLFW_PRESS) {
-            input += glm::vec3{-1.0f, 0.0f, 0.0f};
+        // remesh chunks that changed, from snapshots so the meshes match the revision they are recorded at
+        {
+            stale.clear();
+            stale_snapshots.clear();
+            stale_chunks.clear();
+            for (auto& entry : render_chunks) {
+                if (entry.revision == world.revision(entry.coord)) continue;
+                auto& snapshot = stale_snapshots.emplace_back(world.snapshot(entry.coord));
+                entry.revision = snapshot.revision();
+                stale.push_back(&entry);
+                stale_chunks.push_back(snapshot.get());
+            }
+
+            if (pulling) {
+                stale_faces.resize(stale.size());
+                mesher.mesh_faces(pool, std::span<const ja::world_chunk* const>{stale_chunks}, std::span{stale_faces});
+                for (auto [entry, faces] : std::views::zip(stale, stale_faces)) {
+                    entry->faces.upload(faces);
+                }
+            } else {
+                stale_meshes.resize(stale.size());
+                mesher.mesh(pool, std::span<const ja::world_chunk* const>{stale_chunks}, std::span{stale_meshes});
+                for (auto [entry, data] : std::views::zip(stale, stale_meshes)) {
+                    entry->mesh.upload(data);
+                }
+            }
+
+            for (auto [entry, chunk] : std::views::zip(stale, stale_chunks)) {
+                entry->occluders.clear();
+                ja::collect_occluders(*chunk, glm::vec3{entry->coord * ja::chunk_size}, entry->occluders);
+            }
+
+            // later edits don't need to copy these chunks
+            stale_snapshots.clear();
         }
 
-        if (glfwGetKey(window.get(), GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS) {
-            input += glm::vec3{0.0f, -1.0f, 0.0f};
+        // remesh fluids whose surface or surrounding blocks changed
+        for (auto& entry : render_chunks) {
+            const auto revision = fluids.revision(entry.coord);
+            if (entry.fluid_revision == revision) continue;
+            entry.fluid_revision = revision;
+
+            ja::make_fluid_mesh(fluids, world, entry.coord, entry.fluid_vertices);
+            ja::sort_back_to_front(entry.fluid_vertices, camera.pos - glm::vec3{entry.coord * ja::chunk_size}, sort_arena, entry.fluid_indices);
+            entry.sorted_from = ja::block_coord(camera.pos);
+            entry.fluid.upload(ja::mesh_data{entry.fluid_vertices, entry.fluid_indices});
         }
 
-        if (glfwGetKey(window.get(), GLFW_KEY_SPACE) == GLFW_PRESS) {
-            input += glm::vec3{0.0f, 1.0f, 0.0f};
+        const glm::mat4 view = glm::lookAt(camera.pos, camera.pos + camera.forward, camera.up);
+        {
+            int location = glGetUniformLocation(program.get(), "view");
+            glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(view));
         }
 
-        if (glm::length(input) > 0.0f) {
-            glm::vec3 forward = glm::normalize(glm::vec3{camera.forward.x, 0.0f, camera.forward.z});
-            glm::vec3 right = glm::normalize(glm::cross(camera.up, camera.forward));
-            camera.pos += forward * speed * delta_time * glm::normalize(input).z;
-            camera.pos += right * speed * delta_time * glm::normalize(input).x;
-            camera.pos.y += speed * delta_time * glm::normalize(input).y;
+        // chunks that can be seen through the caves and open air around the camera
+        {
+            visibility.update(world, pool);
+            visibility.visible_chunks(camera.pos, camera.forward, reachable);
+
+            candidates.clear();
+            bounds.clear();
+            for (auto coord : reachable) {
+                const auto index = render_chunk_indices.at(coord);
+                candidates.push_back(index);
+                bounds.push_back(ja::chunk_bounds(render_chunks[index].coord));
+            }
+
+            const auto& stats = visibility.stats();
+            total_reachable += stats.visible;
+            total_visibility_ms += stats.update_ms + stats.search_ms;
         }
 
+        // chunks out of sight and untouched for a while are kept compressed
+        compressor.update(world, input.time, reachable);
+
+        // occlusion culling
         {
-            static glm::mat4 model = glm::mat4(1.0f);
-            model = glm::rotate(model, ja::degrees(45.0f * static_cast<float>(delta_time)).radians(), glm::vec3{0.0f, 1.0f, 0.0f});
-            model = glm::mat4(1.0f);
+            culler.begin(proj * view);
+
+            occluder_chunks.clear();
+            for (const auto& entry : render_chunks) {
+                occluder_chunks.push_back(&entry);
+            }
+
+            auto distance = [](const render_chunk* entry) {
+                return glm::distance(camera.pos, ja::chunk_bounds(entry->coord).center());
+            };
+            const auto count = std::min(occluder_chunks.size(), occluder_chunk_count);
+            std::ranges::partial_sort(occluder_chunks, occluder_chunks.begin() + count, std::less{}, distance);
+
+            for (const auto* entry : occluder_chunks | std::views::take(count)) {
+                for (const auto& occluder : entry->occluders) {
+                    culler.add_occluder(occluder);
+                }
+            }
+
+            culler.rasterize(pool);
+
+            visible.resize(bounds.size());
+            culler.test(bounds, visible);
+
+            const auto& stats = culler.stats();
+            total_culled += stats.culled;
+            total_occlusion_ms += stats.raster_ms + stats.test_ms;
+        }
+
+        for (auto [index, is_visible] : std::views::zip(candidates, visible)) {
+            if (!is_visible) continue;
+            const auto& entry = render_chunks[index];
+
+            const glm::mat4 model = glm::translate(glm::mat4{1.0f}, glm::vec3{entry.coord * ja::chunk_size});
             int location = glGetUniformLocation(program.get(), "model");
             glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(model));
+
+            if (pulling) {
+                glBindVertexArray(pulling_vao.get());
+                entry.faces.bind(0);
+                glDrawArrays(GL_TRIANGLES, 0, entry.faces.vertex_count());
+            } else {
+                glBindVertexArray(entry.mesh.vertex_array());
+                glDrawElements(GL_TRIANGLES, entry.mesh.index_count(), GL_UNSIGNED_INT, 0);
+            }
         }
 
+        // translucent fluids on top of everything else, from back to front
         {
-            glm::mat4 view = glm::lookAt(camera.pos, camera.pos + camera.forward, camera.up);
-            int location = glGetUniformLocation(program.get(), "view");
-            glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(view));
+            translucent.clear();
+            for (auto [index, is_visible] : std::views::zip(candidates, visible)) {
+                if (is_visible && render_chunks[index].fluid.index_count() > 0) {
+                    translucent.push_back(&render_chunks[index]);
+                }
+            }
+            std::ranges::sort(translucent, std::greater{}, [](const render_chunk* entry) {
+                return glm::distance(camera.pos, ja::chunk_bounds(entry->coord).center());
+            });
+
+            glUseProgram(fluid_program.get());
+            glUniformMatrix4fv(glGetUniformLocation(fluid_program.get(), "view"), 1, GL_FALSE, glm::value_ptr(view));
+            glUniform1f(glGetUniformLocation(fluid_program.get(), "alpha"), 0.6f);
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            glDepthMask(GL_FALSE);
+
+            // faces only need to be reordered once the camera is in another block
+            const auto eye = ja::block_coord(camera.pos);
+            for (auto* entry : translucent) {
+                const glm::vec3 origin{entry->coord * ja::chunk_size};
+                if (entry->sorted_from != eye) {
+                    entry->sorted_from = eye;
+                    ja::sort_back_to_front(entry->fluid_vertices, camera.pos - origin, sort_arena, entry->fluid_indices);
+                    entry->fluid.upload_indices(entry->fluid_indices);
+                }
+
+                const glm::mat4 model = glm::translate(glm::mat4{1.0f}, origin);
+                glUniformMatrix4fv(glGetUniformLocation(fluid_program.get(), "model"), 1, GL_FALSE, glm::value_ptr(model));
+                glBindVertexArray(entry->fluid.vertex_array());
+                glDrawElements(GL_TRIANGLES, entry->fluid.index_count(), GL_UNSIGNED_INT, 0);
+            }
+
+            glDepthMask(GL_TRUE);
+            glDisable(GL_BLEND);
+            glUseProgram(program.get());
         }
 
-        glDrawElements(GL_TRIANGLES, chunk.index_count(), GL_UNSIGNED_INT, 0);
+        if (const double now = glfwGetTime(); now - title_time >= 1.0) {
+            title_time = now;
+            const auto& visibility_stats = visibility.stats();
+            const auto& stats = culler.stats();
+            const auto title = std::format("voxel-engine | {}/{} chunks reachable | {:.2f} ms | {}/{} chunks culled | occlusion {:.2f} ms",
+                visibility_stats.visible, render_chunks.size(), visibility_stats.update_ms + visibility_stats.search_ms,
+                stats.culled, stats.tested, stats.raster_ms + stats.test_ms);
+            glfwSetWindowTitle(window.get(), title.c_str());
+        }
 
         glfwSwapBuffers(window.get());
         glfwPollEvents();
+        ++frame_count;
+    }
+
+    if (player) {
+        const double elapsed = glfwGetTime() - start_time;
+        std::println("replayed {} frames in {:.3f} s ({:.3f} ms/frame)", frame_count, elapsed, elapsed * 1000.0 / frame_count);
+        // what the render path actually holds on the GPU, next to the comparison made before the replay
+        std::size_t geometry_bytes{};
+        for (const auto& entry : render_chunks) {
+            geometry_bytes += pulling ? entry.faces.geometry_bytes() : entry.mesh.geometry_bytes();
+        }
+        std::println("geometry: {:.2f} MiB uploaded at the end", geometry_bytes / (1024.0 * 1024.0));
+        const auto mesher_stats = mesher.stats();
+        std::println("meshing: {} chunks in {} batches, {} scratch allocations ({} in the last batch, the last one in batch {}), {} KiB scratch memory, {} chunks copied on write",
+            mesher_stats.meshed, mesher_stats.batches, mesher_stats.heap_allocations, mesher_stats.batch_heap_allocations,
+            mesher_stats.last_allocating_batch, mesher_stats.scratch_bytes / 1024, world.copy_count());
+        if (physics_steps > 0) {
+            const auto step_ms = total_physics_ms / physics_steps;
+            std::println("physics: {} bodies, {:.3f} ms/tick ({:.0f} ticks/s)", physics.bodies().size(), step_ms, 1000.0 / step_ms);
+        }
+        if (tick_count > 0) {
+            const auto& stats = ticks.stats();
+            std::println("block ticks: {} active chunks, {} skipped, {:.3f} ms/tick ({:.0f} ticks/s)",
+                stats.active_chunks, stats.skipped_chunks, total_tick_ms / tick_count, tick_count * 1000.0 / total_tick_ms);
+        }
+        if (server) {
+            const auto& stats = server->stats();
+            std::println("replication: {} ticks, {} chunks and {} deltas in {} KiB, {:.3f} ms latency on average",
+                stats.ticks, stats.chunks, stats.deltas, stats.bytes / 1024, stats.ticks > 0 ? stats.total_latency_ms / stats.ticks : 0.0f);
+        }
+        if (fluid_steps > 0) {
+            std::println("fluids: {} wet cells, {:.1f} cells updated per step, {:.3f} ms/step",
+                fluids.wet_cells(), static_cast<double>(fluid_updates) / fluid_steps, total_fluid_ms / fluid_steps);
+        }
+        std::println("visibility graph: {:.1f}/{} chunks reachable, {:.3f} ms/frame", static_cast<double>(total_reachable) / frame_count, render_chunks.size(), total_visibility_ms / frame_count);
+        std::println("occlusion culling: {:.1f} chunks culled, {:.3f} ms/frame", static_cast<double>(total_culled) / frame_count, total_occlusion_ms / frame_count);
+        const auto compression = compressor.stats();
+        const auto decompression = world.decompression();
+        std::println("compression: {}/{} chunks compressed, {} KiB instead of {} KiB, {:.3f} ms compressing",
+            compression.compressed, world.chunk_count(), compression.compressed_bytes / 1024, compression.raw_bytes / 1024, compression.compress_ms);
+        std::println("decompression: {} chunks on first access, {:.3f} ms on average, {:.3f} ms at most, {} corrupt",
+            decompression.count, decompression.count > 0 ? decompression.total_ms / decompression.count : 0.0f, decompression.max_ms, decompression.failures);
     }
 }
 
@@ -0,0 +1,169 @@
+#include <network/protocol.h>
+
+#include <algorithm>
+#include <world/chunk_codec.h>
+#include <world/world.h>
+
+namespace ja {
+
+namespace {
+
+constexpr std::size_t max_varint_size{10};
+
+/**
+ * Messages are small apart from chunks, anything larger is garbage.
+ */
+constexpr std::uint64_t max_message_size{1 << 20};
+
+/**
+ * Append a frame made of a header and a body, which doesn't need to be copied into the header first.
+ */
+void write_frame(std::vector<std::uint8_t>& out, std::span<const std::uint8_t> header, std::span<const std::uint8_t> body = {}) {
+    write_varint(out, header.size() + body.size());
+    out.insert(out.end(), header.begin(), header.end());
+    out.insert(out.end(), body.begin(), body.end());
+}
+
+[[nodiscard]] std::vector<std::uint8_t>& begin_header(message_type type) {
+    thread_local std::vector<std::uint8_t> header{};
+    header.clear();
+    header.push_back(static_cast<std::uint8_t>(type));
+    return header;
+}
+
+void write_coord(std::vector<std::uint8_t>& out, glm::ivec3 pos) {
+    for (int axis = 0; axis < 3; ++axis) {
+        write_varint(out, zigzag_encode(pos[axis]));
+    }
+}
+
+/**
+ * Whether some bytes start with a whole varint, which read_varint can't tell.
+ */
+[[nodiscard]] bool starts_with_varint(std::span<const std::uint8_t> in) {
+    const auto end = std::min(in.size(), max_varint_size);
+    return std::ranges::any_of(in.first(end), [](std::uint8_t byte) { return (byte & 0x80) == 0; });
+}
+
+[[nodiscard]] bool read_field(std::span<const std::uint8_t>& in, std::uint64_t& value) {
+    if (!starts_with_varint(in)) return false;
+    value = read_varint(in);
+    return true;
+}
+
+[[nodiscard]] bool read_signed(std::span<const std::uint8_t>& in, int& value) {
+    std::uint64_t field{};
+    if (!read_field(in, field)) return false;
+    value = static_cast<int>(zigzag_decode(field));
+    return true;
+}
+
+[[nodiscard]] bool read_coord(std::span<const std::uint8_t>& in, glm::ivec3& pos) {
+    return read_signed(in, pos.x) && read_signed(in, pos.y) && read_signed(in, pos.z);
+}
+
+}
+
+void write_view(std::vector<std::uint8_t>& out, glm::ivec3 block, int radius) {
+    auto& header = begin_header(message_type::view);
+    write_coord(header, block);
+    write_varint(header, zigzag_encode(radius));
+    write_frame(out, header);
+}
+
+void write_set_block(std::vector<std::uint8_t>& out, glm::ivec3 pos, int block) {
+    auto& header = begin_header(message_type::set_block);
+    write_coord(header, pos);
+    write_varint(header, zigzag_encode(block));
+    write_frame(out, header);
+}
+
+void write_chunk(std::vector<std::uint8_t>& out, glm::ivec3 chunk, std::span<const std::uint8_t> compressed) {
+    auto& header = begin_header(message_type::chunk);
+    write_coord(header, chunk);
+    write_frame(out, header, compressed);
+}
+
+void write_delta(std::vector<std::uint8_t>& out, glm::ivec3 chunk, std::span<const block_change> changes) {
+    auto& header = begin_header(message_type::delta);
+    write_coord(header, chunk);
+
+    // changes tend to be next to each other, which makes most increments 0
+    std::uint32_t next{};
+    for (auto [index, block] : changes) {
+        write_varint(header, index - next);
+        write_varint(header, zigzag_encode(block));
+        next = index + 1;
+    }
+    write_frame(out, header);
+}
+
+void write_unload(std::vector<std::uint8_t>& out, glm::ivec3 chunk) {
+    auto& header = begin_header(message_type::unload);
+    write_coord(header, chunk);
+    write_frame(out, header);
+}
+
+void write_tick(std::vector<std::uint8_t>& out, std::uint64_t tick, std::uint64_t time_us) {
+    auto& header = begin_header(message_type::tick);
+    write_varint(header, tick);
+    write_varint(header, time_us);
+    write_frame(out, header);
+}
+
+read_status read_message(std::span<const std::uint8_t>& in, message& message) {
+    auto remaining = in;
+    std::uint64_t size{};
+    if (!read_field(remaining, size)) {
+        return (in.size() < max_varint_size) ? read_status::partial : read_status::invalid;
+    }
+    if (size == 0 || size > max_message_size) return read_status::invalid;
+    if (remaining.size() < size) return read_status::partial;
+
+    auto frame = remaining.first(size);
+    const auto type = frame.front();
+    frame = frame.subspan(1);
+    if (type > static_cast<std::uint8_t>(message_type::tick)) return read_status::invalid;
+    message.type = static_cast<message_type>(type);
+
+    bool valid{};
+    switch (message.type) {
+    case message_type::view:
+    case message_type::set_block:
+        valid = read_coord(frame, message.pos) && read_signed(frame, message.value) && frame.empty();
+        break;
+    case message_type::chunk:
+    case message_type::delta:
+        valid = read_coord(frame, message.pos);
+        message.data = frame;
+        break;
+    case message_type::unload:
+        valid = read_coord(frame, message.pos) && frame.empty();
+        break;
+    case message_type::tick:
+        valid = read_field(frame, message.tick) && read_field(frame, message.time_us) && frame.empty();
+        break;
+    }
+    if (!valid) return read_status::invalid;
+
+    in = remaining.subspan(size);
+    return read_status::complete;
+}
+
+bool read_changes(std::span<const std::uint8_t> data, std::vector<block_change>& changes) {
+    changes.clear();
+    std::uint64_t next{};
+    while (!data.empty()) {
+        std::uint64_t increment{};
+        int block{};
+        if (!read_field(data, increment) || !read_signed(data, block)) return false;
+
+        if (increment >= world_chunk::volume - next) return false;
+        const auto index = next + increment;
+        changes.push_back(block_change{static_cast<std::uint32_t>(index), block});
+        next = index + 1;
+    }
+    return true;
+}
+
+}
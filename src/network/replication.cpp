@@ -0,0 +1,343 @@
+#include <network/replication.h>
+
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <tuple>
+#include <utility>
+#include <world/block.h>
+#include <world/chunk_codec.h>
+
+namespace ja {
+
+namespace {
+
+/**
+ * Clients that fall this far behind are disconnected rather than buffered for.
+ */
+constexpr std::size_t max_backlog{64 * 1024 * 1024};
+
+[[nodiscard]] bool before(glm::ivec3 a, glm::ivec3 b) {
+    return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z);
+}
+
+/**
+ * Send the queued bytes of a connection that fit into its socket.
+ *
+ * @return Number of bytes sent, or nothing if the connection failed.
+ */
+std::optional<std::size_t> send_queued(const socket_handle& socket, std::vector<std::uint8_t>& out, std::size_t& sent) {
+    if (sent == out.size()) return 0;
+
+    const auto count = send_some(socket, std::span{out}.subspan(sent));
+    if (!count) return std::nullopt;
+
+    sent += *count;
+    if (sent == out.size()) {
+        out.clear();
+        sent = 0;
+    } else if (sent > out.size() / 2) {
+        out.erase(out.begin(), out.begin() + static_cast<std::ptrdiff_t>(sent));
+        sent = 0;
+    }
+    return count;
+}
+
+}
+
+std::uint64_t replication_time_us() {
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(now).count());
+}
+
+void replication_server::receive(world& world) {
+    while (auto socket = accept_connection(listener_)) {
+        clients_.push_back(client{.socket = std::move(*socket)});
+    }
+
+    for (auto& client : clients_) {
+        if (!receive_some(client.socket, client.in)) client.closed = true;
+
+        std::span<const std::uint8_t> remaining{client.in};
+        message message{};
+        while (!client.closed) {
+            const auto status = read_message(remaining, message);
+            if (status == read_status::partial) break;
+
+            // clients only send views and blocks, and only place known blocks in chunks that exist
+            if (status == read_status::invalid) {
+                client.closed = true;
+            } else if (message.type == message_type::view) {
+                const auto view = chunk_coord(message.pos);
+                const auto radius = std::clamp(message.value, 0, max_view_radius);
+                client.view_changed |= view != client.view || radius != client.radius;
+                client.view = view;
+                client.radius = radius;
+            } else if (message.type == message_type::set_block && is_known_block(message.value)) {
+                if (world.revision(chunk_coord(message.pos)) != 0) world.set_block(message.pos, message.value);
+            } else {
+                client.closed = true;
+            }
+        }
+        client.in.erase(client.in.begin(), client.in.end() - static_cast<std::ptrdiff_t>(remaining.size()));
+    }
+
+    drop_closed();
+}
+
+void replication_server::publish(const world& world, thread_pool& pool, std::uint64_t tick) {
+    const auto start = std::chrono::steady_clock::now();
+    const auto time_us = replication_time_us();
+    stats_ = replication_stats{.clients = clients_.size(), .total_bytes = stats_.total_bytes};
+
+    // chunks that were created come into view of the clients that see them, which aren't subscribed to them yet
+    if (!tracker_) tracker_ = world.track_changes();
+    world.take_changes(*tracker_, world_changes_);
+    for (auto& client : clients_) {
+        if (!client.view_changed && client.radius >= 0) {
+            client.view_changed = std::ranges::any_of(world_changes_, [&](glm::ivec3 coord) {
+                return glm::all(glm::lessThanEqual(glm::abs(coord - client.view), glm::ivec3{client.radius})) && !client.subscribed.contains(coord);
+            });
+        }
+        update_interest(world, client);
+    }
+
+    changed_.clear();
+    previous_.clear();
+    for (auto it = chunks_.begin(); it != chunks_.end();) {
+        auto& [coord, chunk] = *it;
+        if (chunk.subscribers == 0) {
+            it = chunks_.erase(it);
+            continue;
+        }
+
+        chunk.delta.clear();
+        chunk.changes = 0;
+        if (world.revision(coord) != chunk.snapshot.revision()) {
+            changed_.emplace_back(coord, &chunk);
+            previous_.push_back(std::exchange(chunk.snapshot, world.snapshot(coord)));
+            chunk.full.clear();
+        }
+        ++it;
+    }
+
+    // the blocks that changed since the previous snapshot
+    pool.parallel_for(changed_.size(), [&](std::size_t i) {
+        thread_local std::vector<block_change> changes{};
+        changes.clear();
+
+        auto [coord, chunk] = changed_[i];
+        const auto& before = *previous_[i];
+        const auto& after = *chunk->snapshot;
+        for (std::uint32_t index = 0; index < world_chunk::volume; ++index) {
+            const auto local = local_from_index(index);
+            const int block = after[local.x, local.y, local.z];
+            if (block != before[local.x, local.y, local.z]) changes.push_back(block_change{index, block});
+        }
+
+        chunk->changes = changes.size();
+        if (!changes.empty()) write_delta(chunk->delta, coord, changes);
+    });
+    previous_.clear();
+
+    // whole chunks for the clients that just started to see them, compressed once for all of them
+    missing_.clear();
+    for (const auto& client : clients_) {
+        for (auto coord : client.added) {
+            auto& chunk = chunks_.at(coord);
+            if (chunk.full.empty()) missing_.emplace_back(coord, &chunk);
+        }
+    }
+    std::ranges::sort(missing_, [](const auto& a, const auto& b) { return before(a.first, b.first); });
+    const auto [first, last] = std::ranges::unique(missing_);
+    missing_.erase(first, last);
+
+    pool.parallel_for(missing_.size(), [&](std::size_t i) {
+        auto [coord, chunk] = missing_[i];
+        write_chunk(chunk->full, coord, compress_blocks(chunk->snapshot->blocks()));
+    });
+
+    pool.parallel_for(clients_.size(), [&](std::size_t i) {
+        auto& client = clients_[i];
+        client.deltas = 0;
+        client.queued = 0;
+        if (client.radius < 0) return;
+
+        const auto size = client.out.size();
+        for (auto coord : client.removed) {
+            write_unload(client.out, coord);
+        }
+        for (auto coord : client.added) {
+            const auto& full = chunks_.at(coord).full;
+            client.out.insert(client.out.end(), full.begin(), full.end());
+        }
+
+        // chunks that were just sent whole are already up to date
+        for (auto [coord, chunk] : changed_) {
+            if (chunk->delta.empty() || !client.subscribed.contains(coord) || std::ranges::contains(client.added, coord)) continue;
+            client.out.insert(client.out.end(), chunk->delta.begin(), chunk->delta.end());
+            ++client.deltas;
+        }
+
+        write_tick(client.out, tick, time_us);
+        client.queued = client.out.size() - size;
+    });
+
+    for (const auto& client : clients_) {
+        stats_.chunks += client.added.size();
+        stats_.deltas += client.deltas;
+        stats_.bytes += client.queued;
+    }
+    for (auto [coord, chunk] : changed_) {
+        stats_.changes += chunk->changes;
+    }
+
+    flush();
+    stats_.publish_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool replication_server::flush() {
+    bool pending{};
+    for (auto& client : clients_) {
+        if (client.closed) continue;
+
+        const auto count = send_queued(client.socket, client.out, client.sent);
+        if (!count || client.out.size() - client.sent > max_backlog) {
+            client.closed = true;
+            continue;
+        }
+        stats_.total_bytes += *count;
+        pending |= client.sent < client.out.size();
+    }
+    drop_closed();
+    return pending;
+}
+
+void replication_server::update_interest(const world& world, client& client) {
+    client.added.clear();
+    client.removed.clear();
+    if (!client.view_changed || client.radius < 0) return;
+    client.view_changed = false;
+
+    wanted_.clear();
+    const auto radius = client.radius;
+    for (int x = -radius; x <= radius; ++x) {
+        for (int y = -radius; y <= radius; ++y) {
+            for (int z = -radius; z <= radius; ++z) {
+                const auto coord = client.view + glm::ivec3{x, y, z};
+                if (world.revision(coord) != 0) wanted_.push_back(coord);
+            }
+        }
+    }
+
+    for (auto coord : wanted_) {
+        if (!client.subscribed.insert(coord).second) continue;
+        client.added.push_back(coord);
+
+        auto [it, inserted] = chunks_.try_emplace(coord);
+        if (inserted) it->second.snapshot = world.snapshot(coord);
+        ++it->second.subscribers;
+    }
+
+    // wanted is sorted by construction, x first
+    for (auto coord : client.subscribed) {
+        if (!std::ranges::binary_search(wanted_, coord, before)) client.removed.push_back(coord);
+    }
+    for (auto coord : client.removed) {
+        client.subscribed.erase(coord);
+        --chunks_.at(coord).subscribers;
+    }
+}
+
+void replication_server::drop_closed() {
+    for (const auto& client : clients_) {
+        if (!client.closed) continue;
+        for (auto coord : client.subscribed) {
+            --chunks_.at(coord).subscribers;
+        }
+    }
+    std::erase_if(clients_, [](const auto& client) { return client.closed; });
+}
+
+void replication_client::set_view(glm::ivec3 block, int radius) {
+    if (chunk_coord(block) == view_ && radius == radius_) return;
+    view_ = chunk_coord(block);
+    radius_ = radius;
+    write_view(out_, block, radius);
+}
+
+void replication_client::set_block(glm::ivec3 pos, int block) {
+    write_set_block(out_, pos, block);
+}
+
+bool replication_client::update(world* world) {
+    if (!send_queued(socket_, out_, sent_)) return false;
+
+    const auto size = in_.size();
+    const bool open = receive_some(socket_, in_);
+    stats_.bytes += in_.size() - size;
+
+    std::span<const std::uint8_t> remaining{in_};
+    message message{};
+    while (true) {
+        const auto status = read_message(remaining, message);
+        if (status == read_status::partial) break;
+        if (status == read_status::invalid || !apply(world, message)) return false;
+    }
+    in_.erase(in_.begin(), in_.end() - static_cast<std::ptrdiff_t>(remaining.size()));
+    return open;
+}
+
+bool replication_client::apply(world* world, const message& message) {
+    switch (message.type) {
+    case message_type::chunk: {
+        thread_local world_chunk scratch{};
+        auto& chunk = (world != nullptr) ? world->chunk_at(message.pos) : scratch;
+        if (!decompress_blocks(message.data, chunk.blocks())) return false;
+        if (world != nullptr) world->invalidate(message.pos);
+
+        loaded_.insert(message.pos);
+        ++stats_.chunks;
+        return true;
+    }
+    case message_type::delta: {
+        if (!read_changes(message.data, changes_) || !loaded_.contains(message.pos)) return false;
+        if (world != nullptr) {
+            auto& chunk = world->chunk_at(message.pos);
+            for (auto [index, block] : changes_) {
+                const auto local = local_from_index(index);
+                chunk[local.x, local.y, local.z] = block;
+            }
+            world->invalidate(message.pos);
+        }
+
+        ++stats_.deltas;
+        stats_.changes += changes_.size();
+        return true;
+    }
+    case message_type::unload:
+        if (loaded_.erase(message.pos) == 0) return false;
+        if (auto* chunk = (world != nullptr) ? world->find_chunk(message.pos) : nullptr) {
+            std::ranges::fill(chunk->blocks(), blocks::empty);
+            world->invalidate(message.pos);
+        }
+
+        ++stats_.unloads;
+        return true;
+    case message_type::tick: {
+        const auto now = replication_time_us();
+        stats_.latency_ms = (now > message.time_us) ? static_cast<float>(now - message.time_us) / 1000.0f : 0.0f;
+        stats_.total_latency_ms += stats_.latency_ms;
+        stats_.max_latency_ms = std::max(stats_.max_latency_ms, stats_.latency_ms);
+        ++stats_.ticks;
+        stats_.last_tick = message.tick;
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+}
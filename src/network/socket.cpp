@@ -0,0 +1,170 @@
+#include <network/socket.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <string>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace ja {
+
+namespace {
+
+/**
+ * A parsed address, which fits both kinds of socket addresses.
+ */
+struct socket_address {
+    sockaddr_storage storage{};
+    socklen_t size{};
+    int family{};
+    std::string path{};
+};
+
+[[nodiscard]] std::optional<socket_address> parse_address(std::string_view address) {
+    socket_address result{};
+
+    if (address.starts_with("unix:")) {
+        result.path = address.substr(5);
+        auto& un = reinterpret_cast<sockaddr_un&>(result.storage);
+        if (result.path.empty() || result.path.size() >= sizeof(un.sun_path)) {
+            errno = EINVAL;
+            return std::nullopt;
+        }
+        un.sun_family = AF_UNIX;
+        std::ranges::copy(result.path, un.sun_path);
+        result.size = sizeof(sockaddr_un);
+        result.family = AF_UNIX;
+        return result;
+    }
+
+    const auto colon = address.rfind(':');
+    std::uint16_t port{};
+    const auto port_text = address.substr(colon + 1);
+    if (colon == std::string_view::npos ||
+        std::from_chars(port_text.data(), port_text.data() + port_text.size(), port).ec != std::errc{}) {
+        errno = EINVAL;
+        return std::nullopt;
+    }
+
+    auto& in = reinterpret_cast<sockaddr_in&>(result.storage);
+    in.sin_family = AF_INET;
+    in.sin_port = htons(port);
+    if (inet_pton(AF_INET, std::string{address.substr(0, colon)}.c_str(), &in.sin_addr) != 1) {
+        errno = EINVAL;
+        return std::nullopt;
+    }
+    result.size = sizeof(sockaddr_in);
+    result.family = AF_INET;
+    return result;
+}
+
+/**
+ * Finish setting up a connected socket: updates are small and should go out right away.
+ */
+[[nodiscard]] bool configure(int socket, int family) {
+    if (family == AF_INET) {
+        const int enable{1};
+        if (setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable)) != 0) return false;
+    }
+    return fcntl(socket, F_SETFL, fcntl(socket, F_GETFL) | O_NONBLOCK) == 0;
+}
+
+}
+
+void socket_deleter::operator()(int socket) const {
+    if (socket > 0) close(socket);
+}
+
+std::optional<socket_handle> listen_on(std::string_view address) {
+    const auto parsed = parse_address(address);
+    if (!parsed) return std::nullopt;
+
+    socket_handle socket{::socket(parsed->family, SOCK_STREAM, 0)};
+    if (socket.get() < 0) return std::nullopt;
+
+    if (parsed->family == AF_UNIX) {
+        unlink(parsed->path.c_str());
+    } else {
+        const int enable{1};
+        setsockopt(socket.get(), SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    }
+
+    if (bind(socket.get(), reinterpret_cast<const sockaddr*>(&parsed->storage), parsed->size) != 0 ||
+        listen(socket.get(), SOMAXCONN) != 0 ||
+        fcntl(socket.get(), F_SETFL, fcntl(socket.get(), F_GETFL) | O_NONBLOCK) != 0) {
+        return std::nullopt;
+    }
+    return socket;
+}
+
+std::optional<socket_handle> connect_to(std::string_view address) {
+    const auto parsed = parse_address(address);
+    if (!parsed) return std::nullopt;
+
+    socket_handle socket{::socket(parsed->family, SOCK_STREAM, 0)};
+    if (socket.get() < 0) return std::nullopt;
+
+    if (connect(socket.get(), reinterpret_cast<const sockaddr*>(&parsed->storage), parsed->size) != 0 ||
+        !configure(socket.get(), parsed->family)) {
+        return std::nullopt;
+    }
+    return socket;
+}
+
+std::optional<socket_handle> accept_connection(const socket_handle& listener) {
+    sockaddr_storage address{};
+    socklen_t size{sizeof(address)};
+    socket_handle socket{accept(listener.get(), reinterpret_cast<sockaddr*>(&address), &size)};
+    if (socket.get() < 0 || !configure(socket.get(), address.ss_family)) return std::nullopt;
+    return socket;
+}
+
+std::optional<std::size_t> send_some(const socket_handle& socket, std::span<const std::uint8_t> bytes) {
+    std::size_t sent{};
+    while (sent < bytes.size()) {
+        const auto count = send(socket.get(), bytes.data() + sent, bytes.size() - sent, MSG_NOSIGNAL);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            return std::nullopt;
+        }
+        sent += static_cast<std::size_t>(count);
+    }
+    return sent;
+}
+
+bool receive_some(const socket_handle& socket, std::vector<std::uint8_t>& buffer) {
+    constexpr std::size_t block_size{64 * 1024};
+    while (true) {
+        const auto size = buffer.size();
+        buffer.resize(size + block_size);
+        const auto count = recv(socket.get(), buffer.data() + size, block_size, 0);
+        const auto error = errno;
+        buffer.resize(size + static_cast<std::size_t>(std::max<ssize_t>(count, 0)));
+
+        if (count == 0) return false;
+        if (count < 0) {
+            if (error == EINTR) continue;
+            return error == EAGAIN || error == EWOULDBLOCK;
+        }
+    }
+}
+
+void wait_readable(std::span<const socket_handle* const> sockets, int timeout_ms) {
+    thread_local std::vector<pollfd> descriptors{};
+    descriptors.clear();
+    for (const auto* socket : sockets) {
+        descriptors.push_back(pollfd{.fd = socket->get(), .events = POLLIN, .revents = 0});
+    }
+    poll(descriptors.data(), descriptors.size(), timeout_ms);
+}
+
+}
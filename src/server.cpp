@@ -0,0 +1,295 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <optional>
+#include <print>
+#include <random>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+#include <network/replication.h>
+#include <network/socket.h>
+#include <utility/thread_pool.h>
+#include <world/block.h>
+#include <world/block_behaviors.h>
+#include <world/terrain.h>
+#include <world/tick_scheduler.h>
+#include <world/world.h>
+
+namespace {
+
+constexpr auto tick_duration = std::chrono::microseconds{50'000};
+
+/**
+ * Command line options.
+ *
+ * --listen <address> accept clients on "unix:<path>" or "<IPv4 address>:<port>"
+ *                    (default 127.0.0.1:7777)
+ * --ticks <n>        stop after n ticks instead of running until killed
+ * --load-test <n>    connect n simulated clients from this process, report
+ *                    bandwidth and tick latency, and exit (200 ticks unless given)
+ */
+struct options {
+    std::string address{"127.0.0.1:7777"};
+    std::optional<std::uint64_t> ticks{};
+    std::size_t load_clients{};
+};
+
+std::optional<options> parse_options(std::span<char*> args) {
+    options result{};
+    for (auto it = args.begin(); it != args.end(); ++it) {
+        const std::string_view arg{*it};
+        if (arg == "--listen" && std::next(it) != args.end()) {
+            result.address = *++it;
+        } else if (arg == "--ticks" && std::next(it) != args.end()) {
+            const std::string_view count{*++it};
+            std::uint64_t ticks{};
+            if (std::from_chars(count.data(), count.data() + count.size(), ticks).ec != std::errc{} || ticks == 0) {
+                std::println(stderr, "invalid tick count: {}", count);
+                return std::nullopt;
+            }
+            result.ticks = ticks;
+        } else if (arg == "--load-test" && std::next(it) != args.end()) {
+            const std::string_view count{*++it};
+            if (std::from_chars(count.data(), count.data() + count.size(), result.load_clients).ec != std::errc{}) {
+                std::println(stderr, "invalid client count: {}", count);
+                return std::nullopt;
+            }
+        } else {
+            std::println(stderr, "unknown option: {}", arg);
+            return std::nullopt;
+        }
+    }
+    return result;
+}
+
+/**
+ * A client of the load test, which runs around the terrain and places blocks.
+ */
+struct simulated_client {
+    ja::replication_client connection;
+    glm::ivec3 pos{};
+    glm::ivec3 heading{1, 0, 0};
+    bool connected{true};
+};
+
+/**
+ * Move the simulated clients and apply the updates they receive, until stopped.
+ *
+ * Only the first client keeps a copy of the world, to check it against the server afterwards.
+ */
+void run_clients(std::stop_token token, std::vector<simulated_client>& clients, ja::world& mirror, std::atomic<std::uint64_t>& mirror_tick) {
+    using clock = std::chrono::steady_clock;
+    constexpr int view_radius{3};
+    constexpr int extent{120};
+    constexpr auto move_interval = std::chrono::milliseconds{125};
+
+    std::mt19937 random{7};
+    std::uniform_int_distribution<int> turn{0, 7};
+    std::uniform_int_distribution<int> edit{0, 15};
+    const std::array<glm::ivec3, 4> headings{glm::ivec3{1, 0, 0}, glm::ivec3{-1, 0, 0}, glm::ivec3{0, 0, 1}, glm::ivec3{0, 0, -1}};
+
+    std::vector<const ja::socket_handle*> sockets{};
+    for (const auto& client : clients) {
+        sockets.push_back(&client.connection.socket());
+    }
+
+    auto next_move = clock::now();
+    while (!token.stop_requested()) {
+        ja::wait_readable(sockets, 5);
+
+        for (auto [i, client] : std::views::enumerate(clients)) {
+            if (!client.connected) continue;
+            client.connected = client.connection.update(i == 0 ? &mirror : nullptr);
+        }
+        if (clients.front().connected) {
+            mirror_tick.store(clients.front().connection.stats().last_tick, std::memory_order_release);
+        }
+
+        if (clock::now() < next_move) continue;
+        next_move += move_interval;
+
+        // walk on the surface, turning now and then, and sometimes place or dig a block
+        for (auto& client : clients) {
+            if (turn(random) == 0) client.heading = headings[static_cast<std::size_t>(turn(random)) % headings.size()];
+            auto next = client.pos + client.heading;
+            if (glm::any(glm::greaterThan(glm::abs(next), glm::ivec3{extent}))) {
+                client.heading = -client.heading;
+                next = client.pos + client.heading;
+            }
+            client.pos = glm::ivec3{next.x, ja::terrain_height(next.x, next.z) + 1, next.z};
+            client.connection.set_view(client.pos, view_radius);
+
+            if (const auto roll = edit(random); roll == 0) {
+                client.connection.set_block(client.pos, ja::blocks::brick);
+            } else if (roll == 1) {
+                client.connection.set_block(client.pos - glm::ivec3{0, 1, 0}, ja::blocks::empty);
+            }
+        }
+    }
+}
+
+/**
+ * Run the server with simulated clients connected to it, and report the bandwidth and latency of the updates.
+ */
+int run_load_test(const options& options, ja::replication_server& server, ja::world& world, ja::tick_scheduler& ticks, ja::thread_pool& pool) {
+    using clock = std::chrono::steady_clock;
+    std::vector<simulated_client> clients{};
+    std::uniform_int_distribution<int> start{-100, 100};
+    std::mt19937 random{42};
+    for (std::size_t i = 0; i < options.load_clients; ++i) {
+        auto socket = ja::connect_to(options.address);
+        if (!socket) {
+            std::println(stderr, "failed to connect client {} to {}: {}", i, options.address, std::strerror(errno));
+            return EXIT_FAILURE;
+        }
+        const int x = start(random);
+        const int z = start(random);
+        clients.push_back(simulated_client{.connection = ja::replication_client{std::move(*socket)}, .pos = glm::ivec3{x, ja::terrain_height(x, z) + 1, z}});
+    }
+
+    ja::world mirror{};
+    std::atomic<std::uint64_t> mirror_tick{};
+    std::jthread load{[&](std::stop_token token) { run_clients(token, clients, mirror, mirror_tick); }};
+
+    const auto tick_count = options.ticks.value_or(200);
+    std::vector<float> tick_ms{};
+    ja::replication_stats total{};
+    std::uint64_t late_bytes{};
+
+    auto next = clock::now();
+    for (std::uint64_t tick = 1; tick <= tick_count; ++tick) {
+        const auto tick_start = clock::now();
+        server.receive(world);
+        ticks.tick(world, pool);
+        server.publish(world, pool, tick);
+        tick_ms.push_back(std::chrono::duration<float, std::milli>(clock::now() - tick_start).count());
+
+        const auto& stats = server.stats();
+        total.chunks += stats.chunks;
+        total.deltas += stats.deltas;
+        total.changes += stats.changes;
+        total.bytes += stats.bytes;
+        if (tick > tick_count / 2) late_bytes += stats.bytes;
+
+        // keep sending what didn't fit into the sockets until the next tick
+        next += tick_duration;
+        while (server.flush() && clock::now() < next) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+        std::this_thread::sleep_until(next);
+    }
+
+    const auto deadline = clock::now() + std::chrono::seconds{5};
+    while ((server.flush() || mirror_tick.load(std::memory_order_acquire) < tick_count) && clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    load.request_stop();
+    load.join();
+
+    // the first client has to see the same blocks as the server for every chunk within its view
+    const auto& loaded = clients.front().connection.loaded();
+    const bool in_sync = mirror_tick.load() == tick_count && std::ranges::all_of(loaded, [&](glm::ivec3 coord) {
+        const auto* expected = std::as_const(world).find_chunk(coord);
+        const auto* actual = std::as_const(mirror).find_chunk(coord);
+        return expected != nullptr && actual != nullptr && std::ranges::equal(expected->blocks(), actual->blocks());
+    });
+
+    std::ranges::sort(tick_ms);
+    const auto average_ms = std::accumulate(tick_ms.begin(), tick_ms.end(), 0.0) / static_cast<double>(tick_ms.size());
+    const auto p99_ms = tick_ms[tick_ms.size() * 99 / 100];
+
+    float latency_ms{};
+    float max_latency_ms{};
+    std::uint64_t received_ticks{};
+    std::size_t disconnected{};
+    for (const auto& client : clients) {
+        const auto& stats = client.connection.stats();
+        latency_ms += stats.total_latency_ms;
+        max_latency_ms = std::max(max_latency_ms, stats.max_latency_ms);
+        received_ticks += stats.ticks;
+        disconnected += !client.connected;
+    }
+
+    constexpr double mebibyte{1024.0 * 1024.0};
+    const auto late_seconds = static_cast<double>(tick_count - tick_count / 2) * std::chrono::duration<double>(tick_duration).count();
+    std::println("{} clients over {} for {} ticks of {} ms ({} threads)",
+        clients.size(), options.address, tick_count, std::chrono::duration_cast<std::chrono::milliseconds>(tick_duration).count(), pool.size());
+    std::println("  tick: {:.3f} ms on average, {:.3f} ms p99, {:.3f} ms at most to receive, simulate and publish",
+        average_ms, p99_ms, tick_ms.back());
+    std::println("  latency: {:.3f} ms on average, {:.3f} ms at most from publishing a tick to a client applying it",
+        received_ticks > 0 ? latency_ms / static_cast<float>(received_ticks) : 0.0f, max_latency_ms);
+    std::println("  sent {:.2f} MiB: {} chunks and {} deltas with {} changed blocks, {:.2f} KiB/s per client in the second half",
+        total.bytes / mebibyte, total.chunks, total.deltas, total.changes, late_bytes / 1024.0 / late_seconds / static_cast<double>(clients.size()));
+    std::println("  first client in sync: {} ({} chunks in view), {} clients disconnected",
+        in_sync ? "yes" : "no", loaded.size(), disconnected);
+    return in_sync && disconnected == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    using clock = std::chrono::steady_clock;
+    const auto options = parse_options(std::span{argv, static_cast<std::size_t>(argc)}.subspan(1));
+    if (!options) return EXIT_FAILURE;
+
+    auto listener = ja::listen_on(options->address);
+    if (!listener) {
+        std::println(stderr, "failed to listen on {}: {}", options->address, std::strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    ja::thread_pool pool{};
+    ja::world world{};
+    ja::generate_terrain(world, glm::ivec3{-8, 0, -8}, glm::ivec3{8, 4, 8}, pool);
+
+    ja::tick_scheduler ticks{};
+    ja::add_grass_spread(ticks);
+
+    ja::replication_server server{std::move(*listener)};
+    if (options->load_clients > 0) {
+        return run_load_test(*options, server, world, ticks, pool);
+    }
+
+    std::println("listening on {}", options->address);
+
+    // report once every 5 seconds
+    constexpr std::uint64_t report_interval{100};
+    double window_ms{};
+    std::uint64_t window_bytes{};
+
+    auto next = clock::now();
+    for (std::uint64_t tick = 1; !options->ticks || tick <= *options->ticks; ++tick) {
+        const auto tick_start = clock::now();
+        server.receive(world);
+        ticks.tick(world, pool);
+        server.publish(world, pool, tick);
+        window_ms += std::chrono::duration<double, std::milli>(clock::now() - tick_start).count();
+        window_bytes += server.stats().bytes;
+
+        if (tick % report_interval == 0) {
+            const auto seconds = static_cast<double>(report_interval) * std::chrono::duration<double>(tick_duration).count();
+            std::println("tick {}: {} clients, {:.3f} ms/tick, {:.1f} KiB/s", tick, server.client_count(), window_ms / report_interval, window_bytes / 1024.0 / seconds);
+            window_ms = 0.0;
+            window_bytes = 0;
+        }
+
+        next += tick_duration;
+        while (server.flush() && clock::now() < next) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+        std::this_thread::sleep_until(next);
+    }
+}
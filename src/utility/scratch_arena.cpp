@@ -0,0 +1,42 @@
+#include <utility/scratch_arena.h>
+#include <algorithm>
+#include <numeric>
+
+namespace ja {
+
+void scratch_arena::reset() {
+    if (buffers_.size() > 1) {
+        const auto size = capacity();
+        buffers_.clear();
+        add_buffer(size);
+    }
+    offset_ = 0;
+    used_ = 0;
+}
+
+std::size_t scratch_arena::capacity() const {
+    return std::accumulate(buffers_.begin(), buffers_.end(), 0uz, [](std::size_t sum, const buffer& buffer) {
+        return sum + buffer.size;
+    });
+}
+
+std::byte* scratch_arena::allocate_bytes(std::size_t size, std::size_t alignment) {
+    std::size_t offset = (offset_ + alignment - 1) / alignment * alignment;
+
+    if (buffers_.empty() || offset + size > buffers_.back().size) {
+        const auto previous = buffers_.empty() ? 0uz : buffers_.back().size;
+        add_buffer(std::max({size, 2 * previous, min_buffer_size}));
+        offset = 0;
+    }
+
+    offset_ = offset + size;
+    used_ += size;
+    return buffers_.back().data.get() + offset;
+}
+
+void scratch_arena::add_buffer(std::size_t size) {
+    buffers_.push_back(buffer{std::make_unique_for_overwrite<std::byte[]>(size), size});
+    ++heap_allocations_;
+}
+
+}
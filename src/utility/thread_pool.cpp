@@ -0,0 +1,58 @@
+#include <utility/thread_pool.h>
+
+namespace ja {
+
+namespace {
+
+thread_local const thread_pool* current_pool{};
+thread_local std::size_t current_index{};
+
+}
+
+thread_pool::thread_pool(std::size_t thread_count) {
+    thread_count = std::max(thread_count, 1uz);
+    for (std::size_t i = 0; i < thread_count; ++i) {
+        workers_.emplace_back([this, i](std::stop_token token) {
+            work(token, i);
+        });
+    }
+}
+
+thread_pool::~thread_pool() {
+    for (auto& worker : workers_) {
+        worker.request_stop();
+    }
+    condition_.notify_all();
+    workers_.clear();
+}
+
+void thread_pool::submit(std::function<void()> task) {
+    {
+        std::lock_guard lock{mutex_};
+        tasks_.push(std::move(task));
+    }
+    condition_.notify_one();
+}
+
+std::size_t thread_pool::current_worker() const {
+    return (current_pool == this) ? current_index : size();
+}
+
+void thread_pool::work(std::stop_token token, std::size_t index) {
+    current_pool = this;
+    current_index = index;
+
+    while (true) {
+        std::function<void()> task{};
+        {
+            std::unique_lock lock{mutex_};
+            condition_.wait(lock, token, [this] { return !tasks_.empty(); });
+            if (tasks_.empty()) return;
+            task = std::move(tasks_.front());
+            tasks_.pop();
+        }
+        task();
+    }
+}
+
+}
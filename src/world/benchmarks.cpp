@@ -0,0 +1,534 @@
+#include <world/benchmarks.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <print>
+#include <random>
+#include <ranges>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+#include <utility/scratch_arena.h>
+#include <utility/thread_pool.h>
+#include <world/block.h>
+#include <world/block_behaviors.h>
+#include <world/brick_map.h>
+#include <world/chunk_codec.h>
+#include <world/edit_journal.h>
+#include <world/face_mesh.h>
+#include <world/fluid.h>
+#include <world/navigation.h>
+#include <world/raycast.h>
+#include <world/terrain.h>
+#include <world/tick_scheduler.h>
+#include <world/world_edit.h>
+
+namespace ja {
+
+namespace {
+
+/**
+ * Fill a square of chunks with dirt below stripes of grass, and a clock in
+ * every chunk: a block whose scheduled tick schedules the next one.
+ */
+void make_tick_world(world& world, tick_scheduler& scheduler, thread_pool& pool, int chunks, bool idle_layer) {
+    const int size = chunks * chunk_size / 2;
+    fill_box(world, pool, glm::ivec3{-size, idle_layer ? -chunk_size : 0, -size}, glm::ivec3{size - 1, 8, size - 1}, blocks::dirt);
+    for (int z = -size; z < size; z += chunk_size) {
+        fill_box(world, pool, glm::ivec3{-size, 8, z}, glm::ivec3{size - 1, 8, z}, blocks::grass);
+    }
+
+    add_grass_spread(scheduler);
+    scheduler.on_scheduled(blocks::brick, [](tick_context& context, glm::ivec3 pos, int) {
+        context.schedule(pos, 1);
+    });
+    for (int x = -size; x < size; x += chunk_size) {
+        for (int z = -size; z < size; z += chunk_size) {
+            const glm::ivec3 clock{x + 8, 12, z + 8};
+            world.set_block(clock, blocks::brick);
+            scheduler.schedule(world, clock, 1);
+        }
+    }
+}
+
+}
+
+void report_storage(const world& world) {
+    using clock = std::chrono::steady_clock;
+    auto elapsed_ms = [](clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    };
+
+    struct group {
+        std::string_view name{};
+        std::size_t chunks{};
+        std::size_t dense_bytes{};
+        std::size_t brick_bytes{};
+        std::size_t compressed_bytes{};
+        double dense_ms{};
+        double brick_ms{};
+        double decompress_ms{};
+        double dense_mesh_ms{};
+        double brick_mesh_ms{};
+        double lod_ms{};
+        std::size_t faces{};
+        std::size_t lod_faces{};
+        std::size_t mismatches{};
+    };
+
+    std::array groups{
+        group{.name = "0%"}, group{.name = "< 25%"}, group{.name = "< 75%"},
+        group{.name = "< 100%"}, group{.name = "100%"},
+    };
+
+    constexpr std::size_t rays_per_chunk{1024};
+    constexpr std::size_t lod_factor{2};
+    constexpr float size{chunk_size};
+    std::mt19937 rng{42};
+    std::uniform_real_distribution<float> position{-0.5f, size - 0.5f};
+    std::uniform_real_distribution<float> direction{-1.0f, 1.0f};
+
+    std::vector<std::pair<glm::vec3, glm::vec3>> rays(rays_per_chunk);
+    std::size_t hits{};
+    auto decompressed = std::make_unique<world_chunk>();
+    scratch_arena arena{};
+
+    for (auto coord : world.chunks()) {
+        const auto& chunk = *world.find_chunk(coord);
+        const brick_map<chunk_size, chunk_size, chunk_size> bricks{chunk};
+
+        const auto fill = static_cast<double>(bricks.solid_count()) / world_chunk::volume;
+        auto& group = groups[fill == 0.0 ? 0 : fill < 0.25 ? 1 : fill < 0.75 ? 2 : fill < 1.0 ? 3 : 4];
+        ++group.chunks;
+        group.dense_bytes += sizeof(chunk);
+        group.brick_bytes += bricks.memory_bytes();
+
+        const auto compressed = compress_blocks(chunk.blocks());
+        group.compressed_bytes += compressed.size();
+        auto start = clock::now();
+        decompress_blocks(compressed, decompressed->blocks());
+        group.decompress_ms += elapsed_ms(start);
+
+        for (auto& [origin, dir] : rays) {
+            origin = {position(rng), position(rng), position(rng)};
+            dir = {direction(rng), direction(rng), direction(rng) + 0.01f};
+        }
+
+        start = clock::now();
+        for (auto [origin, dir] : rays) {
+            hits += raycast(chunk, origin, dir, size * 2.0f).has_value();
+        }
+        group.dense_ms += elapsed_ms(start);
+
+        start = clock::now();
+        for (auto [origin, dir] : rays) {
+            hits += raycast(bricks, origin, dir, size * 2.0f).has_value();
+        }
+        group.brick_ms += elapsed_ms(start);
+
+        // both meshers have to find the same faces, though bricks visit them in another order
+        arena.reset();
+        start = clock::now();
+        auto dense_faces = make_chunk_faces(chunk, arena);
+        group.dense_mesh_ms += elapsed_ms(start);
+
+        start = clock::now();
+        auto brick_faces = make_chunk_faces(bricks, arena);
+        group.brick_mesh_ms += elapsed_ms(start);
+
+        group.faces += brick_faces.size();
+        std::ranges::sort(dense_faces);
+        std::ranges::sort(brick_faces);
+        group.mismatches += !std::ranges::equal(dense_faces, brick_faces);
+
+        start = clock::now();
+        const auto lod = bricks.downsample<lod_factor>();
+        group.lod_faces += make_chunk_faces(lod, arena).size();
+        group.lod_ms += elapsed_ms(start);
+    }
+
+    std::println("storage: {} rays per chunk, {} hits", rays_per_chunk, hits);
+    for (const auto& group : groups) {
+        if (group.chunks == 0) continue;
+        std::println("  {:>6} solid: {:>3} chunks, dense {:>5} KiB, bricks {:>5} KiB, raycast dense {:.3f} ms, bricks {:.3f} ms",
+            group.name, group.chunks, group.dense_bytes / 1024, group.brick_bytes / 1024, group.dense_ms, group.brick_ms);
+        std::println("  {:>6}        compressed {:>5} KiB ({:.1f}x), {:.4f} ms/chunk to decompress",
+            "", group.compressed_bytes / 1024, static_cast<double>(group.dense_bytes) / group.compressed_bytes, group.decompress_ms / group.chunks);
+        std::println("  {:>6}        faces dense {:.4f} ms/chunk, bricks {:.4f} ms/chunk{}, {} faces; {}x coarser {} faces in {:.4f} ms/chunk",
+            "", group.dense_mesh_ms / group.chunks, group.brick_mesh_ms / group.chunks, group.mismatches > 0 ? " (MISMATCH)" : "",
+            group.faces, lod_factor, group.lod_faces, group.lod_ms / group.chunks);
+    }
+}
+
+void run_journal_benchmark() {
+    using clock = std::chrono::steady_clock;
+    auto elapsed_ms = [](clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    };
+
+    thread_pool pool{};
+    constexpr glm::ivec3 min_chunk{-4, 0, -4};
+    constexpr glm::ivec3 max_chunk{4, 3, 4};
+    const auto directory = std::filesystem::temp_directory_path();
+    const auto journal_path = (directory / "voxel-engine-journal.bin").string();
+    const auto chunks_path = (directory / "voxel-engine-chunks.bin").string();
+
+    for (std::size_t edit_count : {1'000uz, 100'000uz, 10'000'000uz}) {
+        world world{};
+        generate_terrain(world, min_chunk, max_chunk, pool);
+
+        std::unordered_map<glm::ivec3, std::uint64_t, ivec3_hash> generated{};
+        for (auto coord : world.chunks()) {
+            generated[coord] = world.revision(coord);
+        }
+
+        edit_journal journal{};
+        world.set_journal(&journal);
+
+        std::mt19937 rng{42};
+        std::uniform_int_distribution<int> x{min_chunk.x * chunk_size, max_chunk.x * chunk_size - 1};
+        std::uniform_int_distribution<int> y{min_chunk.y * chunk_size, max_chunk.y * chunk_size - 1};
+        std::uniform_int_distribution<int> z{min_chunk.z * chunk_size, max_chunk.z * chunk_size - 1};
+        std::uniform_int_distribution<int> block{blocks::empty, blocks::brick};
+
+        for (std::size_t i = 0; i < edit_count; ++i) {
+            world.set_block({x(rng), y(rng), z(rng)}, block(rng));
+        }
+
+        auto start = clock::now();
+        journal.save(journal_path);
+        const auto journal_save_ms = elapsed_ms(start);
+
+        // a full save writes every chunk that changed, compressed
+        start = clock::now();
+        std::vector<std::size_t> sizes{};
+        {
+            std::ofstream ofs{chunks_path, std::ios::binary | std::ios::trunc};
+            for (auto coord : world.chunks()) {
+                if (world.revision(coord) == generated[coord]) continue;
+                const auto data = compress_blocks(std::as_const(world).find_chunk(coord)->blocks());
+                ofs.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+                sizes.push_back(data.size());
+            }
+        }
+        const auto chunks_save_ms = elapsed_ms(start);
+
+        start = clock::now();
+        {
+            std::ifstream ifs{chunks_path, std::ios::binary};
+            std::vector<std::uint8_t> data{};
+            auto chunk = std::make_unique<world_chunk>();
+            for (auto size : sizes) {
+                data.resize(size);
+                ifs.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(size));
+                decompress_blocks(data, chunk->blocks());
+            }
+        }
+        const auto chunks_load_ms = elapsed_ms(start);
+
+        ja::world replayed{};
+        generate_terrain(replayed, min_chunk, max_chunk, pool);
+        start = clock::now();
+        const bool valid = replay_journal(journal_path, replayed);
+        const auto replay_ms = elapsed_ms(start);
+
+        const bool same = world.chunk_count() == replayed.chunk_count() && std::ranges::all_of(world.chunks(), [&](glm::ivec3 coord) {
+            return std::ranges::equal(std::as_const(world).find_chunk(coord)->blocks(), std::as_const(replayed).find_chunk(coord)->blocks());
+        });
+
+        world.set_journal(nullptr);
+        std::println("{:>8} edits: journal {:>9} KiB, saved in {:8.2f} ms, replayed in {:8.2f} ms{}",
+            edit_count, std::filesystem::file_size(journal_path) / 1024, journal_save_ms, replay_ms, valid && same ? "" : " (mismatch)");
+        std::println("{:>8}        {:>3} chunks {:>6} KiB, saved in {:8.2f} ms, loaded in {:8.2f} ms",
+            "", sizes.size(), std::filesystem::file_size(chunks_path) / 1024, chunks_save_ms, chunks_load_ms);
+    }
+
+    std::filesystem::remove(journal_path);
+    std::filesystem::remove(chunks_path);
+}
+
+void run_edit_benchmark() {
+    using clock = std::chrono::steady_clock;
+    thread_pool pool{};
+    world world{};
+
+    constexpr int size{512};
+    const glm::ivec3 min{-size / 2, 0, -size / 2};
+    const glm::ivec3 max = min + (size - 1);
+
+    // throughput is measured over the whole region, changed or not
+    auto report = [](std::string_view name, int extent, const edit_stats& stats) {
+        const double blocks = static_cast<double>(extent) * extent * extent;
+        std::println("{:>16}: {:>6} chunks, {:>10} blocks changed in {:9.2f} ms ({:.0f} M blocks/s)",
+            name, stats.chunks, stats.blocks, stats.ms, blocks / stats.ms / 1000.0);
+    };
+
+    // the first fill creates the chunks as well
+    report("fill (new)", size, fill_box(world, pool, min, max, blocks::dirt));
+    report("fill", size, fill_box(world, pool, min, max, blocks::grass));
+    report("replace", size, replace_blocks(world, pool, min, max, blocks::grass, blocks::brick));
+    report("sphere", size, fill_sphere(world, pool, min + size / 2, size / 2.0f, blocks::orange));
+
+    auto start = clock::now();
+    const auto copy = copy_region(world, pool, min, min + 127);
+    const auto copy_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    std::println("{:>16}: {} blocks in {:.2f} ms", "copy 128^3", copy.blocks.size(), copy_ms);
+    report("paste 128^3", 128, paste(world, pool, copy.rotated(1), max - 127, true));
+
+    // single blocks go through a chunk lookup and an invalidation each, so only a corner is done
+    constexpr int corner{128};
+    start = clock::now();
+    for (int x = 0; x < corner; ++x) {
+        for (int y = 0; y < corner; ++y) {
+            for (int z = 0; z < corner; ++z) {
+                world.set_block(min + glm::ivec3{x, y, z}, blocks::empty);
+            }
+        }
+    }
+    const auto single_ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+    std::println("{:>16}: {} blocks in {:.2f} ms ({:.0f} M blocks/s)",
+        "set_block 128^3", corner * corner * corner, single_ms, corner * corner * corner / single_ms / 1000.0);
+}
+
+void run_tick_benchmark() {
+    using clock = std::chrono::steady_clock;
+    constexpr int tick_count{200};
+
+    {
+        thread_pool pool{};
+        world world{};
+        tick_scheduler scheduler{};
+        make_tick_world(world, scheduler, pool, 100, true);
+
+        // the first tick counts the blocks with random ticks of every chunk
+        scheduler.tick(world, pool);
+        std::println("setup: {} chunks, counting random blocks took {:.2f} ms", world.chunk_count(), scheduler.stats().ms);
+
+        tick_stats total{};
+        const auto start = clock::now();
+        for (int i = 0; i < tick_count; ++i) {
+            scheduler.tick(world, pool);
+            const auto& stats = scheduler.stats();
+            total.scheduled += stats.scheduled;
+            total.random += stats.random;
+        }
+        const auto ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+        const auto& stats = scheduler.stats();
+        std::println("{} ticks: {} active and {} skipped chunks, {:.3f} ms/tick ({:.0f} ticks/s, {} threads)",
+            tick_count, stats.active_chunks, stats.skipped_chunks, ms / tick_count, tick_count * 1000.0 / ms, pool.size());
+        std::println("  {:.0f} scheduled and {:.0f} random block updates per tick ({:.1f} M updates/s)",
+            static_cast<double>(total.scheduled) / tick_count, static_cast<double>(total.random) / tick_count,
+            (total.scheduled + total.random) / ms / 1000.0);
+    }
+
+    // the same ticks on one and on all threads have to give the same world
+    constexpr int chunks{16};
+    thread_pool single{1};
+    thread_pool pool{};
+    world a{};
+    world b{};
+    tick_scheduler a_scheduler{7};
+    tick_scheduler b_scheduler{7};
+    make_tick_world(a, a_scheduler, single, chunks, false);
+    make_tick_world(b, b_scheduler, pool, chunks, false);
+    for (int i = 0; i < tick_count; ++i) {
+        a_scheduler.tick(a, single);
+        b_scheduler.tick(b, pool);
+    }
+
+    const bool same = a.chunk_count() == b.chunk_count() && std::ranges::all_of(a.chunks(), [&](glm::ivec3 coord) {
+        const auto* other = std::as_const(b).find_chunk(coord);
+        return other != nullptr && std::ranges::equal(std::as_const(a).find_chunk(coord)->blocks(), other->blocks());
+    });
+    std::println("deterministic: {} ({} chunks, 1 and {} threads)", same ? "yes" : "no", a.chunk_count(), pool.size());
+}
+
+void run_fluid_benchmark() {
+    using clock = std::chrono::steady_clock;
+    thread_pool pool{};
+    world world{};
+
+    const terrain_params terrain{};
+    generate_terrain(world, glm::ivec3{-8, 0, -8}, glm::ivec3{8, 4, 8}, pool, terrain);
+
+    fluid_simulation fluids{};
+    std::size_t sources{};
+    for (int x = -120; x < 128; x += 16) {
+        for (int z = -120; z < 128; z += 16) {
+            sources += fluids.add_source(world, glm::ivec3{x, terrain_height(x, z, terrain) + 2, z});
+        }
+    }
+
+    constexpr int max_steps{2000};
+    std::size_t updated{};
+    std::size_t remeshed{};
+    float slowest_ms{};
+    int steps{};
+    const auto start = clock::now();
+    while (steps < max_steps && fluids.active_cells() > 0) {
+        fluids.step(world, pool);
+        const auto& stats = fluids.stats();
+        updated += stats.updated;
+        remeshed += stats.remeshed;
+        slowest_ms = std::max(slowest_ms, stats.ms);
+        ++steps;
+    }
+    const auto ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+    std::println("{} sources came to rest after {} steps in {:.2f} ms ({:.3f} ms/step, {:.3f} ms at most, {} threads)",
+        sources, steps, ms, ms / steps, slowest_ms, pool.size());
+    std::println("  {} cells updated ({:.1f} M cells/s), {} wet cells, {} chunk remeshes",
+        updated, updated / ms / 1000.0, fluids.wet_cells(), remeshed);
+}
+
+void run_nav_benchmark() {
+    using clock = std::chrono::steady_clock;
+    thread_pool pool{};
+    world world{};
+
+    const terrain_params terrain{};
+    generate_terrain(world, glm::ivec3{-8, 0, -8}, glm::ivec3{8, 4, 8}, pool, terrain);
+
+    nav_graph graph{pool};
+    graph.update(world, pool);
+    auto stats = graph.stats();
+    std::println("graph: {} clusters, {} nodes, {} edges, built in {:.2f} ms ({} threads)",
+        stats.clusters, stats.nodes, stats.edges, stats.update_ms, pool.size());
+
+    constexpr std::size_t agent_count{4096};
+    std::mt19937 random{42};
+    std::uniform_int_distribution<int> column{-120, 119};
+    auto surface_cell = [&] {
+        while (true) {
+            const glm::ivec3 cell{column(random), 0, column(random)};
+            for (int y = terrain_height(cell.x, cell.z, terrain) + 1; y > 0; --y) {
+                if (graph.walkable(glm::ivec3{cell.x, y, cell.z})) return glm::ivec3{cell.x, y, cell.z};
+            }
+        }
+    };
+
+    std::vector<nav_query> queries(agent_count);
+    for (auto& query : queries) {
+        query = nav_query{surface_cell(), surface_cell()};
+    }
+    std::vector<nav_path> paths(agent_count);
+
+    auto run_queries = [&](std::string_view name) {
+        const auto start = clock::now();
+        graph.find_paths(pool, queries, paths);
+        const auto ms = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+
+        const auto found = std::ranges::count_if(paths, [](const auto& path) { return !path.empty(); });
+        std::size_t steps{};
+        for (const auto& path : paths) {
+            steps += path.size();
+        }
+        std::println("{}: {} paths in {:.2f} ms ({:.0f} paths/s), {} found, {:.1f} steps on average",
+            name, agent_count, ms, agent_count * 1000.0 / ms, found, static_cast<double>(steps) / std::max<std::ptrdiff_t>(found, 1));
+    };
+    run_queries("queries");
+
+    const auto edit = fill_box(world, pool, glm::ivec3{-128, 1, -3}, glm::ivec3{96, 63, 3}, blocks::empty);
+    graph.update(world, pool);
+    stats = graph.stats();
+    std::println("canyon: {} chunks changed, graph updated in {:.2f} ms ({} clusters rebuilt, {} nodes, {} edges)",
+        edit.chunks, stats.update_ms, stats.rebuilt, stats.nodes, stats.edges);
+    run_queries("queries around the canyon");
+}
+
+bool run_snapshot_stress() {
+    using clock = std::chrono::steady_clock;
+    constexpr int extent{4};
+    constexpr std::size_t reader_count{4};
+    constexpr auto duration = std::chrono::seconds{5};
+
+    world world{};
+    std::vector<glm::ivec3> coords{};
+    for (auto [x, y, z] : std::views::cartesian_product(std::views::iota(0, extent), std::views::iota(0, extent), std::views::iota(0, extent))) {
+        coords.emplace_back(x, y, z);
+        std::ranges::fill(world.chunk_at(coords.back()).blocks(), blocks::dirt);
+    }
+
+    // every write fills a chunk with a single block, so a snapshot is intact if all its blocks are the same
+    struct held_snapshot {
+        chunk_snapshot snapshot{};
+        int block{};
+    };
+
+    std::mutex mutex{};
+    std::vector<held_snapshot> shared{};
+    std::atomic<std::size_t> checked{};
+    std::atomic<std::size_t> broken{};
+
+    auto check = [&](const held_snapshot& held) {
+        const bool intact = std::ranges::all_of(held.snapshot->blocks(), [&](int block) { return block == held.block; });
+        broken.fetch_add(!intact, std::memory_order_relaxed);
+        checked.fetch_add(1, std::memory_order_relaxed);
+    };
+
+    // readers check their snapshots twice, a while apart, and release them on their own thread
+    std::vector<std::jthread> readers{};
+    for (std::size_t i = 0; i < reader_count; ++i) {
+        readers.emplace_back([&](std::stop_token token) {
+            std::vector<held_snapshot> held{};
+            while (!token.stop_requested()) {
+                {
+                    std::lock_guard lock{mutex};
+                    std::swap(held, shared);
+                }
+                std::ranges::for_each(held, check);
+                std::this_thread::yield();
+                std::ranges::for_each(held, check);
+                held.clear();
+            }
+        });
+    }
+
+    std::mt19937 rng{42};
+    std::uniform_int_distribution<std::size_t> pick{0, coords.size() - 1};
+    std::uniform_int_distribution<int> block{blocks::grass, blocks::brick};
+    std::size_t writes{};
+
+    const auto end = clock::now() + duration;
+    while (clock::now() < end) {
+        const auto coord = coords[pick(rng)];
+        const int value = block(rng);
+
+        // whole chunks through a pointer, or block by block
+        if (writes % 2 == 0) {
+            std::ranges::fill(world.find_chunk(coord)->blocks(), value);
+            world.invalidate(coord);
+        } else {
+            for (auto [x, y, z] : std::views::cartesian_product(std::views::iota(0, chunk_size), std::views::iota(0, chunk_size), std::views::iota(0, chunk_size))) {
+                world.set_block(coord * chunk_size + glm::ivec3{x, y, z}, value);
+            }
+        }
+        ++writes;
+
+        std::lock_guard lock{mutex};
+        shared.push_back(held_snapshot{world.snapshot(coord), value});
+    }
+
+    for (auto& reader : readers) {
+        reader.request_stop();
+        reader.join();
+    }
+
+    std::println("snapshots: {} writes to {} chunks, {} checks on {} threads, {} chunks copied on write, {} broken",
+        writes, coords.size(), checked.load(), reader_count, world.copy_count(), broken.load());
+    return broken.load() == 0;
+}
+
+}
@@ -0,0 +1,29 @@
+#include <world/block_behaviors.h>
+
+#include <world/block.h>
+
+namespace ja {
+
+void add_grass_spread(tick_scheduler& scheduler) {
+    scheduler.on_random(blocks::grass, [](tick_context& context, glm::ivec3 pos, int) {
+        if (!is_empty(context.get_block(pos + glm::ivec3{0, 1, 0}))) {
+            context.set_block(pos, blocks::dirt);
+            return;
+        }
+
+        // a few tries within 3x5x3 blocks, mostly below as grass spreads down slopes
+        for (int attempt = 0; attempt < 4; ++attempt) {
+            const auto r = context.random();
+            const glm::ivec3 target = pos + glm::ivec3{
+                static_cast<int>(r % 3) - 1,
+                static_cast<int>(r / 3 % 5) - 3,
+                static_cast<int>(r / 15 % 3) - 1,
+            };
+            if (context.get_block(target) == blocks::dirt && is_empty(context.get_block(target + glm::ivec3{0, 1, 0}))) {
+                context.set_block(target, blocks::grass);
+            }
+        }
+    });
+}
+
+}
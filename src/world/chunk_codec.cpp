@@ -0,0 +1,151 @@
+#include <world/chunk_codec.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace ja {
+
+namespace {
+
+constexpr std::size_t min_match{4};
+constexpr std::size_t max_offset{65535};
+constexpr int hash_bits{12};
+
+[[nodiscard]] std::uint32_t read32(const std::uint8_t* p) {
+    std::uint32_t value{};
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+[[nodiscard]] std::uint32_t hash(std::uint32_t value) {
+    return (value * 2654435761u) >> (32 - hash_bits);
+}
+
+/**
+ * Append a length that didn't fit in its 4 bits of the token.
+ */
+void write_length(std::vector<std::uint8_t>& out, std::size_t length) {
+    for (; length >= 255; length -= 255) {
+        out.push_back(255);
+    }
+    out.push_back(static_cast<std::uint8_t>(length));
+}
+
+[[nodiscard]] bool read_length(std::span<const std::uint8_t>& in, std::size_t& length) {
+    while (true) {
+        if (in.empty()) return false;
+        const auto byte = in.front();
+        in = in.subspan(1);
+        length += byte;
+        if (byte != 255) return true;
+    }
+}
+
+void write_sequence(std::vector<std::uint8_t>& out, std::span<const std::uint8_t> literals, std::size_t offset, std::size_t match) {
+    const auto literal_nibble = std::min<std::size_t>(literals.size(), 15);
+    const auto match_nibble = (match > 0) ? std::min<std::size_t>(match - min_match, 15) : 0;
+    out.push_back(static_cast<std::uint8_t>(literal_nibble << 4 | match_nibble));
+
+    if (literal_nibble == 15) write_length(out, literals.size() - 15);
+    out.insert(out.end(), literals.begin(), literals.end());
+
+    // the last sequence has no match
+    if (match == 0) return;
+
+    out.push_back(static_cast<std::uint8_t>(offset));
+    out.push_back(static_cast<std::uint8_t>(offset >> 8));
+    if (match_nibble == 15) write_length(out, match - min_match - 15);
+}
+
+}
+
+void write_varint(std::vector<std::uint8_t>& out, std::uint64_t value) {
+    for (; value >= 0x80; value >>= 7) {
+        out.push_back(static_cast<std::uint8_t>(value | 0x80));
+    }
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+std::uint64_t read_varint(std::span<const std::uint8_t>& in) {
+    std::uint64_t value{};
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (in.empty()) break;
+        const auto byte = in.front();
+        in = in.subspan(1);
+        value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) return value;
+    }
+    in = {};
+    return 0;
+}
+
+void lz_compress(std::span<const std::uint8_t> in, std::vector<std::uint8_t>& out) {
+    std::array<std::int32_t, 1 << hash_bits> table{};
+    table.fill(-1);
+
+    std::size_t anchor{};
+    std::size_t pos{};
+
+    while (pos + min_match <= in.size()) {
+        const auto value = read32(&in[pos]);
+        auto& slot = table[hash(value)];
+        const auto candidate = static_cast<std::size_t>(slot);
+        const bool found = slot >= 0 && pos - candidate <= max_offset && read32(&in[candidate]) == value;
+        slot = static_cast<std::int32_t>(pos);
+
+        if (!found) {
+            ++pos;
+            continue;
+        }
+
+        auto length = min_match;
+        while (pos + length < in.size() && in[candidate + length] == in[pos + length]) {
+            ++length;
+        }
+
+        write_sequence(out, in.subspan(anchor, pos - anchor), pos - candidate, length);
+        pos += length;
+        anchor = pos;
+    }
+
+    write_sequence(out, in.subspan(anchor), 0, 0);
+}
+
+bool lz_decompress(std::span<const std::uint8_t> in, std::vector<std::uint8_t>& out) {
+    out.clear();
+
+    while (!in.empty()) {
+        const auto token = in.front();
+        in = in.subspan(1);
+
+        std::size_t literals = token >> 4;
+        if (literals == 15 && !read_length(in, literals)) return false;
+        if (literals > in.size()) return false;
+        out.insert(out.end(), in.begin(), in.begin() + static_cast<std::ptrdiff_t>(literals));
+        in = in.subspan(literals);
+
+        if (in.empty()) return true;
+        if (in.size() < 2) return false;
+
+        const std::size_t offset = in[0] | (in[1] << 8);
+        in = in.subspan(2);
+
+        std::size_t match = token & 0x0f;
+        if (match == 15 && !read_length(in, match)) return false;
+        match += min_match;
+
+        if (offset == 0 || offset > out.size()) return false;
+
+        // matches may overlap the bytes they produce
+        const auto start = out.size() - offset;
+        out.reserve(out.size() + match);
+        for (std::size_t i = 0; i < match; ++i) {
+            out.push_back(out[start + i]);
+        }
+    }
+
+    return true;
+}
+
+}
@@ -0,0 +1,95 @@
+#include <world/chunk_compressor.h>
+
+#include <chrono>
+#include <utility>
+#include <world/chunk_codec.h>
+
+namespace ja {
+
+chunk_compressor::chunk_compressor(double idle_seconds)
+    : idle_seconds_{idle_seconds} {
+    worker_ = std::jthread{[this](std::stop_token token) {
+        work(token);
+    }};
+}
+
+void chunk_compressor::update(world& world, double now, std::span<const glm::ivec3> active) {
+    std::vector<result> finished{};
+    {
+        std::lock_guard lock{mutex_};
+        finished.swap(results_);
+        stats_.compress_ms = compress_ms_;
+    }
+
+    // chunks that changed while being compressed stay as they are
+    for (auto& result : finished) {
+        pending_.erase(result.coord);
+        world.store_compressed(result.coord, result.revision, std::move(result.data));
+    }
+
+    for (auto coord : active) {
+        last_used_[coord] = now;
+    }
+
+    std::vector<job> jobs{};
+    stats_.compressed = 0;
+    stats_.compressed_bytes = 0;
+
+    for (auto coord : world.chunks()) {
+        auto [it, inserted] = last_used_.try_emplace(coord, now);
+        if (world.take_accessed(coord)) it->second = now;
+
+        if (world.compressed(coord)) {
+            ++stats_.compressed;
+            stats_.compressed_bytes += world.compressed_bytes(coord);
+            continue;
+        }
+
+        if (inserted || now - it->second < idle_seconds_ || pending_.contains(coord)) continue;
+
+        // chunks that were only read since they were compressed don't need compressing again
+        if (world.release(coord)) continue;
+
+        pending_.insert(coord);
+        jobs.push_back({coord, world.snapshot(coord)});
+    }
+
+    stats_.raw_bytes = stats_.compressed * sizeof(world_chunk);
+    stats_.pending = pending_.size();
+
+    if (jobs.empty()) return;
+    {
+        std::lock_guard lock{mutex_};
+        for (auto& job : jobs) {
+            jobs_.push_back(std::move(job));
+        }
+    }
+    condition_.notify_one();
+}
+
+compression_stats chunk_compressor::stats() const {
+    return stats_;
+}
+
+void chunk_compressor::work(std::stop_token token) {
+    while (true) {
+        job job{};
+        {
+            std::unique_lock lock{mutex_};
+            condition_.wait(lock, token, [this] { return !jobs_.empty(); });
+            if (jobs_.empty()) return;
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        auto data = compress_blocks(job.snapshot->blocks());
+        const auto ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::lock_guard lock{mutex_};
+        results_.push_back({job.coord, job.snapshot.revision(), std::move(data)});
+        compress_ms_ += ms;
+    }
+}
+
+}
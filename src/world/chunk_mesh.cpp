@@ -0,0 +1,75 @@
+#include <world/chunk_mesh.h>
+#include <cstddef>
+
+namespace ja {
+
+void chunk_mesh::upload(const mesh_data& data) {
+    using vertex_type = decltype(data.vertices)::value_type;
+
+    index_count_ = data.indices.size();
+    geometry_bytes_ = data.vertices.size_bytes() + data.indices.size_bytes();
+
+    glBindVertexArray(vao_.get());
+
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_.get());
+    glBufferData(GL_ARRAY_BUFFER, data.vertices.size_bytes(), data.vertices.data(), GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_.get());
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, data.indices.size_bytes(), data.indices.data(), GL_STATIC_DRAW);
+
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(vertex_type), nullptr);
+    glEnableVertexAttribArray(0);
+
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(vertex_type), reinterpret_cast<void*>(offsetof(vertex_type, texcoord)));
+    glEnableVertexAttribArray(1);
+
+    glBindVertexArray(0);
+}
+
+void chunk_mesh::upload_indices(std::span<const unsigned int> indices) {
+    index_count_ = indices.size();
+
+    glBindVertexArray(vao_.get());
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_.get());
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size_bytes(), indices.data(), GL_STREAM_DRAW);
+    glBindVertexArray(0);
+}
+
+mesher_stats chunk_mesher::stats() const {
+    mesher_stats stats{
+        .meshed = meshed_,
+        .batches = batches_,
+        .heap_allocations = heap_allocations(),
+        .batch_heap_allocations = batch_heap_allocations_,
+        .last_allocating_batch = last_allocating_batch_,
+    };
+    for (const auto& arena : arenas_) {
+        stats.scratch_bytes += arena.capacity();
+    }
+    return stats;
+}
+
+void chunk_mesher::begin_batch() {
+    // merging the buffers of an arena on reset allocates too
+    batch_start_allocations_ = heap_allocations();
+    for (auto& arena : arenas_) {
+        arena.reset();
+    }
+}
+
+void chunk_mesher::end_batch(std::size_t count) {
+    meshed_ += count;
+    ++batches_;
+    batch_heap_allocations_ = heap_allocations() - batch_start_allocations_;
+    if (batch_heap_allocations_ > 0) last_allocating_batch_ = batches_;
+}
+
+std::size_t chunk_mesher::heap_allocations() const {
+    std::size_t count{};
+    for (const auto& arena : arenas_) {
+        count += arena.heap_allocations();
+    }
+    return count;
+}
+
+}
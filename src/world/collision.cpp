@@ -0,0 +1,184 @@
+#include <world/collision.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <ranges>
+
+namespace ja {
+
+namespace {
+
+/**
+ * Block lookups that remember the last chunk, as sweeps query neighboring blocks.
+ */
+struct block_query {
+    const world& source;
+    glm::ivec3 coord{};
+    const world_chunk* chunk{};
+    bool valid{};
+
+    [[nodiscard]] bool solid(glm::ivec3 pos) {
+        const auto current = chunk_coord(pos);
+        if (!valid || current != coord) {
+            coord = current;
+            chunk = source.find_chunk(coord);
+            valid = true;
+        }
+        if (chunk == nullptr) return false;
+
+        const auto local = pos - coord * chunk_size;
+        return !is_empty((*chunk)[local.x, local.y, local.z]);
+    }
+};
+
+/**
+ * Obtain the range of blocks that overlap an open interval along one axis.
+ */
+[[nodiscard]] std::pair<int, int> overlapping(float min, float max) {
+    return {static_cast<int>(std::floor(min + 0.5f)), static_cast<int>(std::ceil(max + 0.5f)) - 1};
+}
+
+/**
+ * Move a box along a single axis.
+ */
+bool sweep_axis(block_query& query, aabb& box, int axis, float motion) {
+    if (motion == 0.0f) return false;
+
+    const int u = (axis + 1) % 3;
+    const int v = (axis + 2) % 3;
+    const auto [u_min, u_max] = overlapping(box.min[u], box.max[u]);
+    const auto [v_min, v_max] = overlapping(box.min[v], box.max[v]);
+
+    auto layer_solid = [&](int layer) {
+        glm::ivec3 pos{};
+        pos[axis] = layer;
+        for (pos[u] = u_min; pos[u] <= u_max; ++pos[u]) {
+            for (pos[v] = v_min; pos[v] <= v_max; ++pos[v]) {
+                if (query.solid(pos)) return true;
+            }
+        }
+        return false;
+    };
+
+    const float size = box.max[axis] - box.min[axis];
+
+    if (motion > 0.0f) {
+        // layers whose near side lies in [max, max + motion)
+        const int first = static_cast<int>(std::ceil(box.max[axis] + 0.5f));
+        const int last = static_cast<int>(std::ceil(box.max[axis] + motion + 0.5f)) - 1;
+        for (int layer = first; layer <= last; ++layer) {
+            if (layer_solid(layer)) {
+                box.max[axis] = static_cast<float>(layer) - 0.5f;
+                box.min[axis] = box.max[axis] - size;
+                return true;
+            }
+        }
+    } else {
+        // layers whose near side lies in (min + motion, min]
+        const int first = static_cast<int>(std::floor(box.min[axis] - 0.5f));
+        const int last = static_cast<int>(std::floor(box.min[axis] + motion - 0.5f)) + 1;
+        for (int layer = first; layer >= last; --layer) {
+            if (layer_solid(layer)) {
+                box.min[axis] = static_cast<float>(layer) + 0.5f;
+                box.max[axis] = box.min[axis] + size;
+                return true;
+            }
+        }
+    }
+
+    box.min[axis] += motion;
+    box.max[axis] += motion;
+    return false;
+}
+
+}
+
+move_result move_and_collide(const world& world, aabb& box, glm::vec3 motion) {
+    block_query query{world};
+    const glm::vec3 start = box.min;
+
+    move_result result{};
+    for (int axis : {1, 0, 2}) {
+        result.blocked[axis] = sweep_axis(query, box, axis, motion[axis]);
+    }
+    result.moved = box.min - start;
+    return result;
+}
+
+std::size_t physics_world::add(const body& body) {
+    bodies_.push_back(body);
+    return bodies_.size() - 1;
+}
+
+void physics_world::step(const world& world, float delta_time, thread_pool& pool) {
+    const auto start = std::chrono::steady_clock::now();
+
+    update_occupancy(world);
+
+    std::atomic<std::size_t> collided{};
+    constexpr std::size_t batch_size{256};
+    const std::size_t batch_count = (bodies_.size() + batch_size - 1) / batch_size;
+
+    pool.parallel_for(batch_count, [&](std::size_t batch) {
+        std::size_t batch_collided{};
+        const auto first = batch * batch_size;
+        const auto last = std::min(first + batch_size, bodies_.size());
+
+        for (auto& body : std::span{bodies_}.subspan(first, last - first)) {
+            body.velocity += gravity * delta_time;
+            const glm::vec3 motion = body.velocity * delta_time;
+
+            const aabb swept{glm::min(body.box.min, body.box.min + motion), glm::max(body.box.max, body.box.max + motion)};
+            if (empty_space(swept)) {
+                body.box = body.box.translated(motion);
+                body.on_ground = false;
+                continue;
+            }
+
+            const auto result = move_and_collide(world, body.box, motion);
+            for (int axis = 0; axis < 3; ++axis) {
+                if (result.blocked[axis]) {
+                    body.velocity[axis] = 0.0f;
+                }
+            }
+            body.on_ground = result.blocked.y && motion.y < 0.0f;
+            ++batch_collided;
+        }
+
+        collided += batch_collided;
+    });
+
+    stats_.bodies = bodies_.size();
+    stats_.collided = collided;
+    stats_.skipped = bodies_.size() - collided;
+    stats_.step_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void physics_world::update_occupancy(const world& world) {
+    if (!tracker_) tracker_ = world.track_changes();
+    world.take_changes(*tracker_, changed_);
+
+    for (auto coord : changed_) {
+        solid_blocks_[coord] = static_cast<std::size_t>(std::ranges::count_if(world.find_chunk(coord)->blocks(), std::not_fn(is_empty)));
+    }
+}
+
+bool physics_world::empty_space(const aabb& box) const {
+    const glm::ivec3 min = chunk_coord(block_coord(box.min));
+    const glm::ivec3 max = chunk_coord(block_coord(box.max));
+
+    for (int x = min.x; x <= max.x; ++x) {
+        for (int y = min.y; y <= max.y; ++y) {
+            for (int z = min.z; z <= max.z; ++z) {
+                // chunks that don't exist have no blocks either
+                auto it = solid_blocks_.find(glm::ivec3{x, y, z});
+                if (it != solid_blocks_.end() && it->second > 0) return false;
+            }
+        }
+    }
+    return true;
+}
+
+}
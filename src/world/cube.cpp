@@ -80,4 +80,23 @@ std::span<const cube_vertex, 4> cube_face_vertices(cube_face face) {
     }
 }
 
+glm::ivec3 cube_face_normal(cube_face face) {
+    switch(face) {
+        case cube_face::front:
+            return {0, 0, 1};
+        case cube_face::back:
+            return {0, 0, -1};
+        case cube_face::left:
+            return {-1, 0, 0};
+        case cube_face::right:
+            return {1, 0, 0};
+        case cube_face::top:
+            return {0, 1, 0};
+        case cube_face::bottom:
+            return {0, -1, 0};
+        default:
+            std::unreachable();
+    }
+}
+
 }
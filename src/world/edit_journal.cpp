@@ -0,0 +1,299 @@
+#include <world/edit_journal.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <ranges>
+#include <utility>
+#include <world/chunk_codec.h>
+
+namespace ja {
+
+namespace {
+
+constexpr std::array<char, 4> magic{'J', 'A', 'E', 'D'};
+constexpr std::uint32_t version{1};
+
+static_assert(std::endian::native == std::endian::little, "journals are stored in little-endian byte order");
+
+void push_block(std::vector<block_run>& runs, int block, std::uint32_t length = 1) {
+    if (!runs.empty() && runs.back().block == block) {
+        runs.back().length += length;
+    } else {
+        runs.push_back({length, block});
+    }
+}
+
+void write_blocks(std::vector<std::uint8_t>& out, const std::vector<block_run>& runs) {
+    write_varint(out, runs.size());
+    for (auto [length, block] : runs) {
+        write_varint(out, length);
+        write_varint(out, zigzag_encode(block));
+    }
+}
+
+[[nodiscard]] bool read_blocks(std::span<const std::uint8_t>& in, std::uint32_t count, std::vector<block_run>& runs) {
+    runs.clear();
+    const auto size = read_varint(in);
+    if (size > in.size()) return false;
+
+    std::uint64_t total{};
+    for (std::uint64_t i = 0; i < size; ++i) {
+        const auto length = read_varint(in);
+        const auto block = zigzag_decode(read_varint(in));
+        // checked before narrowing, so the runs can't wrap around to the count
+        if (length == 0 || length > count - total) return false;
+        runs.push_back({static_cast<std::uint32_t>(length), static_cast<int>(block)});
+        total += length;
+    }
+    return total == count;
+}
+
+/**
+ * Encode the runs of an operation: the number of runs, then per run the
+ * chunk, the first block and the number of blocks, followed by the blocks
+ * before and after.
+ */
+void encode(std::vector<std::uint8_t>& out, const edit_batch& batch, bool inverse) {
+    write_varint(out, batch.runs.size());
+
+    // an inverse operation reverts the runs in reverse order
+    auto write = [&out, inverse](const edit_run& run) {
+        write_varint(out, zigzag_encode(run.chunk.x));
+        write_varint(out, zigzag_encode(run.chunk.y));
+        write_varint(out, zigzag_encode(run.chunk.z));
+        write_varint(out, run.start);
+        write_varint(out, run.count);
+        write_blocks(out, inverse ? run.after : run.before);
+        write_blocks(out, inverse ? run.before : run.after);
+    };
+
+    if (inverse) {
+        std::ranges::for_each(batch.runs | std::views::reverse, write);
+    } else {
+        std::ranges::for_each(batch.runs, write);
+    }
+}
+
+[[nodiscard]] bool decode(std::span<const std::uint8_t>& in, edit_batch& batch) {
+    const auto count = read_varint(in);
+    if (count > in.size()) return false;
+
+    // the vectors of runs are reused
+    batch.runs.resize(count);
+    for (auto& run : batch.runs) {
+        run.chunk.x = static_cast<int>(zigzag_decode(read_varint(in)));
+        run.chunk.y = static_cast<int>(zigzag_decode(read_varint(in)));
+        run.chunk.z = static_cast<int>(zigzag_decode(read_varint(in)));
+        const auto start = read_varint(in);
+        const auto length = read_varint(in);
+        if (length > world_chunk::volume || start > world_chunk::volume - length) return false;
+        run.start = static_cast<std::uint32_t>(start);
+        run.count = static_cast<std::uint32_t>(length);
+
+        if (!read_blocks(in, run.count, run.before) || !read_blocks(in, run.count, run.after)) return false;
+    }
+    return true;
+}
+
+}
+
+void edit_batch::add(glm::ivec3 chunk, std::uint32_t index, int before, int after) {
+    if (!runs.empty()) {
+        auto& run = runs.back();
+        if (run.chunk == chunk && run.start + run.count == index) {
+            ++run.count;
+            push_block(run.before, before);
+            push_block(run.after, after);
+            return;
+        }
+    }
+    runs.push_back({chunk, index, 1, {{1, before}}, {{1, after}}});
+}
+
+void edit_batch::add_run(glm::ivec3 chunk, std::uint32_t start, std::span<const int> before, int after) {
+    if (before.empty()) return;
+
+    if (runs.empty() || runs.back().chunk != chunk || runs.back().start + runs.back().count != start) {
+        runs.push_back({chunk, start, 0, {}, {}});
+    }
+
+    auto& run = runs.back();
+    run.count += static_cast<std::uint32_t>(before.size());
+    for (int block : before) {
+        push_block(run.before, block);
+    }
+    push_block(run.after, after, static_cast<std::uint32_t>(before.size()));
+}
+
+std::size_t edit_batch::edit_count() const {
+    std::size_t count{};
+    for (const auto& run : runs) {
+        count += run.count;
+    }
+    return count;
+}
+
+void edit_journal::record(glm::ivec3 chunk, std::uint32_t index, int before, int after) {
+    ++edits_;
+    if (batch_depth_ > 0) {
+        batch_.add(chunk, index, before, after);
+        return;
+    }
+
+    // single edits are by far the most common, so they are encoded without a batch
+    history_.resize(history_.size() - std::exchange(undone_, 0));
+    history_.push_back(log_.size());
+
+    write_varint(log_, 1);
+    write_varint(log_, zigzag_encode(chunk.x));
+    write_varint(log_, zigzag_encode(chunk.y));
+    write_varint(log_, zigzag_encode(chunk.z));
+    write_varint(log_, index);
+    write_varint(log_, 1);
+    for (int block : {before, after}) {
+        write_varint(log_, 1);
+        write_varint(log_, 1);
+        write_varint(log_, zigzag_encode(block));
+    }
+}
+
+void edit_journal::begin_batch() {
+    ++batch_depth_;
+}
+
+void edit_journal::end_batch() {
+    if (--batch_depth_ > 0) return;
+
+    if (!batch_.empty()) {
+        append(batch_);
+    }
+    batch_.clear();
+}
+
+void edit_journal::commit(const edit_batch& batch) {
+    if (batch.empty()) return;
+
+    edits_ += batch.edit_count();
+    if (batch_depth_ > 0) {
+        batch_.runs.insert(batch_.runs.end(), batch.runs.begin(), batch.runs.end());
+        return;
+    }
+
+    append(batch);
+}
+
+bool edit_journal::undo(world& world) {
+    if (!can_undo()) return false;
+
+    std::span<const std::uint8_t> in{log_};
+    in = in.subspan(history_[history_.size() - 1 - undone_]);
+    if (!decode(in, scratch_)) return false;
+
+    apply_edits(world, scratch_, true);
+    ++undone_;
+
+    // the undo itself is logged as the inverse operation, without becoming part of the history
+    encode(log_, scratch_, true);
+    return true;
+}
+
+bool edit_journal::redo(world& world) {
+    if (!can_redo()) return false;
+
+    std::span<const std::uint8_t> in{log_};
+    in = in.subspan(history_[history_.size() - undone_]);
+    if (!decode(in, scratch_)) return false;
+
+    apply_edits(world, scratch_);
+    --undone_;
+
+    encode(log_, scratch_, false);
+    return true;
+}
+
+bool edit_journal::save(const std::string& path) {
+    std::ofstream ofs{path, std::ios::binary | (saved_ == 0 ? std::ios::trunc : std::ios::app)};
+    if (!ofs) return false;
+
+    if (saved_ == 0) {
+        ofs.write(magic.data(), magic.size());
+        const auto bytes = std::bit_cast<std::array<char, sizeof(version)>>(version);
+        ofs.write(bytes.data(), bytes.size());
+    }
+
+    const std::span unsaved = std::span{log_}.subspan(saved_);
+    ofs.write(reinterpret_cast<const char*>(unsaved.data()), static_cast<std::streamsize>(unsaved.size()));
+    if (!ofs) return false;
+
+    saved_ = log_.size();
+    return true;
+}
+
+journal_stats edit_journal::stats() const {
+    return journal_stats{
+        .operations = history_.size(),
+        .edits = edits_,
+        .bytes = log_.size(),
+        .saved_bytes = saved_,
+    };
+}
+
+void edit_journal::append(const edit_batch& batch) {
+    // a new operation can't be followed by the ones that were undone
+    history_.resize(history_.size() - std::exchange(undone_, 0));
+    history_.push_back(log_.size());
+    encode(log_, batch, false);
+}
+
+bool replay_journal(const std::string& path, world& world) {
+    std::ifstream ifs{path, std::ios::binary};
+    if (!ifs) return false;
+
+    const std::vector<std::uint8_t> data{std::istreambuf_iterator<char>{ifs}, std::istreambuf_iterator<char>{}};
+    if (data.size() < magic.size() + sizeof(version)) return false;
+    if (!std::equal(magic.begin(), magic.end(), data.begin())) return false;
+
+    std::uint32_t file_version{};
+    std::memcpy(&file_version, data.data() + magic.size(), sizeof(file_version));
+    if (file_version != version) return false;
+
+    std::span<const std::uint8_t> in{data};
+    in = in.subspan(magic.size() + sizeof(version));
+
+    edit_batch batch{};
+    while (!in.empty()) {
+        if (!decode(in, batch)) return false;
+        apply_edits(world, batch);
+    }
+    return true;
+}
+
+void apply_edits(world& world, const edit_batch& batch, bool revert) {
+    auto apply = [&world](const edit_run& run, const std::vector<block_run>& blocks) {
+        auto& chunk = world.chunk_at(run.chunk);
+        auto index = run.start;
+        for (auto [length, block] : blocks) {
+            for (; length > 0; --length, ++index) {
+                const auto local = local_from_index(index);
+                chunk[local.x, local.y, local.z] = block;
+            }
+        }
+        world.invalidate(run.chunk);
+    };
+
+    if (revert) {
+        for (const auto& run : batch.runs | std::views::reverse) {
+            apply(run, run.before);
+        }
+    } else {
+        for (const auto& run : batch.runs) {
+            apply(run, run.after);
+        }
+    }
+}
+
+}
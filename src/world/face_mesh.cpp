@@ -0,0 +1,17 @@
+#include <world/face_mesh.h>
+
+namespace ja {
+
+void chunk_face_mesh::upload(std::span<const std::uint32_t> faces) {
+    face_count_ = faces.size();
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, ssbo_.get());
+    glBufferData(GL_SHADER_STORAGE_BUFFER, faces.size_bytes(), faces.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void chunk_face_mesh::bind(GLuint index) const {
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, index, ssbo_.get());
+}
+
+}
@@ -0,0 +1,268 @@
+#include <world/fluid.h>
+
+#include <algorithm>
+#include <chrono>
+#include <ranges>
+#include <utility>
+#include <world/block.h>
+
+namespace ja {
+
+namespace {
+
+constexpr glm::ivec3 up{0, 1, 0};
+
+constexpr std::array<glm::ivec3, 4> sideways{
+    glm::ivec3{1, 0, 0}, glm::ivec3{-1, 0, 0},
+    glm::ivec3{0, 0, 1}, glm::ivec3{0, 0, -1},
+};
+
+/**
+ * Compute the next state of a cell from the current states around it.
+ */
+[[nodiscard]] std::uint8_t next_cell(const fluid_neighborhood& around, glm::ivec3 pos) {
+    if (around.solid(pos)) return 0;
+
+    const auto cell = around.cell(pos);
+    if ((cell & fluid_source) != 0) return cell;
+
+    if (around.level(pos + up) > 0) return max_fluid_level;
+
+    int level{};
+    for (auto side : sideways) {
+        const auto from = pos + side;
+        const int from_level = around.level(from);
+        if (from_level <= 1) continue;
+
+        // fluid only spreads sideways once it can't fall any further
+        const auto below = from - up;
+        if (!around.solid(below) && (around.cell(below) & fluid_source) == 0) continue;
+        level = std::max(level, from_level - 1);
+    }
+    return static_cast<std::uint8_t>(level);
+}
+
+}
+
+std::size_t fluid_neighborhood::slot(glm::ivec3 pos) const {
+    const auto offset = chunk_coord(pos) - coord_;
+    const auto slot = static_cast<std::size_t>((offset.x + 1) * 9 + (offset.y + 1) * 3 + offset.z + 1);
+    if ((looked_up_ & (1u << slot)) == 0) {
+        blocks_[slot] = world_.find_chunk(coord_ + offset);
+        cells_[slot] = fluids_.find(coord_ + offset);
+        looked_up_ |= 1u << slot;
+    }
+    return slot;
+}
+
+bool fluid_neighborhood::solid(glm::ivec3 pos) const {
+    const auto* chunk = blocks_[slot(pos)];
+    if (chunk == nullptr) return true;
+
+    const auto local = local_coord(pos);
+    return !is_empty((*chunk)[local.x, local.y, local.z]);
+}
+
+std::uint8_t fluid_neighborhood::cell(glm::ivec3 pos) const {
+    const auto* fluid = cells_[slot(pos)];
+    return (fluid != nullptr) ? (*fluid)[local_index(local_coord(pos))] : 0;
+}
+
+bool fluid_simulation::add_source(const world& world, glm::ivec3 pos) {
+    if (world.revision(chunk_coord(pos)) == 0 || !is_empty(world.get_block(pos))) return false;
+
+    auto& fluid = emplace(world, chunk_coord(pos));
+    auto& cell = fluid.levels[fluid.front][local_index(local_coord(pos))];
+    const bool appeared = cell == 0;
+    cell = fluid_source | max_fluid_level;
+
+    activate_dependents(world, pos);
+    touch(pos, appeared);
+    return true;
+}
+
+void fluid_simulation::remove_source(const world& world, glm::ivec3 pos) {
+    auto it = chunks_.find(chunk_coord(pos));
+    if (it == chunks_.end()) return;
+
+    auto& fluid = it->second;
+    auto& cell = fluid.levels[fluid.front][local_index(local_coord(pos))];
+    if ((cell & fluid_source) == 0) return;
+
+    // the cell is recomputed from its surroundings, it may still be wet from elsewhere
+    cell = 0;
+    activate(world, pos);
+    activate_dependents(world, pos);
+    touch(pos, true);
+}
+
+void fluid_simulation::step(const world& world, thread_pool& pool) {
+    const auto start = std::chrono::steady_clock::now();
+    stats_ = {};
+
+    // blocks that changed may open or close the way for fluid in and next to their chunk
+    changed_blocks_.clear();
+    for (auto& [coord, fluid] : chunks_) {
+        const auto revision = world.revision(coord);
+        if (fluid.block_revision == revision) continue;
+        fluid.block_revision = revision;
+        changed_blocks_.push_back(coord);
+    }
+    for (auto coord : changed_blocks_) {
+        for (auto offset : {glm::ivec3{0}, up, -up, sideways[0], sideways[1], sideways[2], sideways[3]}) {
+            auto it = chunks_.find(coord + offset);
+            if (it == chunks_.end()) continue;
+
+            const auto& fluid = it->second;
+            const auto origin = (coord + offset) * chunk_size;
+            for (std::uint32_t index = 0; index < world_chunk::volume; ++index) {
+                if (fluid[index] == 0) continue;
+                const auto pos = origin + local_from_index(index);
+                activate(world, pos);
+                activate_dependents(world, pos);
+            }
+        }
+        // faces against blocks may have appeared or disappeared
+        if (auto it = chunks_.find(coord); it != chunks_.end()) ++it->second.revision;
+    }
+
+    std::size_t count{};
+    for (auto& [coord, fluid] : chunks_) {
+        if (fluid.active.empty()) continue;
+        if (count == tasks_.size()) tasks_.emplace_back();
+        auto& task = tasks_[count++];
+        task.coord = coord;
+        task.fluid = &fluid;
+        task.changed.clear();
+        task.previous.clear();
+    }
+
+    // every chunk only writes its back buffer, and only reads front buffers
+    pool.parallel_for(count, [&](std::size_t i) {
+        auto& task = tasks_[i];
+        auto& fluid = *task.fluid;
+        const auto& current = fluid.levels[fluid.front];
+        auto& next = fluid.levels[fluid.front ^ 1];
+        next = current;
+
+        const fluid_neighborhood around{*this, world, task.coord};
+        const auto origin = task.coord * chunk_size;
+        for (auto index : fluid.active) {
+            const auto cell = next_cell(around, origin + local_from_index(index));
+            if (cell == current[index]) continue;
+            next[index] = cell;
+            task.changed.push_back(index);
+            task.previous.push_back(current[index]);
+        }
+
+        task.updated = fluid.active.size();
+        fluid.active.clear();
+        fluid.queued.reset();
+    });
+
+    for (auto& task : tasks_ | std::views::take(count)) {
+        task.fluid->front ^= 1;
+    }
+
+    for (auto& task : tasks_ | std::views::take(count)) {
+        const auto origin = task.coord * chunk_size;
+        const auto revision = task.fluid->revision;
+        for (auto [index, previous] : std::views::zip(task.changed, task.previous)) {
+            const auto pos = origin + local_from_index(index);
+            activate_dependents(world, pos);
+
+            // only changes that can be seen need a new mesh
+            const bool appeared = fluid_level(previous) == 0 || fluid_level((*task.fluid)[index]) == 0;
+            if (appeared || level(pos + up) == 0) {
+                touch(pos, appeared);
+            }
+        }
+
+        stats_.updated += task.updated;
+        stats_.changed += task.changed.size();
+        stats_.remeshed += task.fluid->revision != revision;
+    }
+
+    stats_.chunks = count;
+    stats_.ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int fluid_simulation::level(glm::ivec3 pos) const {
+    const auto* fluid = find(chunk_coord(pos));
+    return (fluid != nullptr) ? fluid_level((*fluid)[local_index(local_coord(pos))]) : 0;
+}
+
+const fluid_chunk* fluid_simulation::find(glm::ivec3 chunk) const {
+    auto it = chunks_.find(chunk);
+    return (it != chunks_.end()) ? &it->second : nullptr;
+}
+
+std::uint64_t fluid_simulation::revision(glm::ivec3 chunk) const {
+    auto it = chunks_.find(chunk);
+    return (it != chunks_.end()) ? it->second.revision : 0;
+}
+
+std::size_t fluid_simulation::active_cells() const {
+    std::size_t count{};
+    for (const auto& fluid : chunks_ | std::views::values) {
+        count += fluid.active.size();
+    }
+    return count;
+}
+
+std::size_t fluid_simulation::wet_cells() const {
+    std::size_t count{};
+    for (const auto& fluid : chunks_ | std::views::values) {
+        count += static_cast<std::size_t>(std::ranges::count_if(fluid.levels[fluid.front], [](std::uint8_t cell) {
+            return fluid_level(cell) > 0;
+        }));
+    }
+    return count;
+}
+
+fluid_chunk& fluid_simulation::emplace(const world& world, glm::ivec3 chunk) {
+    auto [it, inserted] = chunks_.try_emplace(chunk);
+    if (inserted) {
+        it->second.block_revision = world.revision(chunk);
+    }
+    return it->second;
+}
+
+void fluid_simulation::activate(const world& world, glm::ivec3 pos) {
+    const auto coord = chunk_coord(pos);
+    if (world.revision(coord) == 0) return;
+
+    auto& fluid = emplace(world, coord);
+    const auto index = local_index(local_coord(pos));
+    if (fluid.queued[index]) return;
+    fluid.queued[index] = true;
+    fluid.active.push_back(index);
+}
+
+void fluid_simulation::activate_dependents(const world& world, glm::ivec3 pos) {
+    // a cell depends on the one above it, the ones beside it and the ones below those
+    activate(world, pos - up);
+    for (auto side : sideways) {
+        activate(world, pos + side);
+        activate(world, pos + up + side);
+    }
+}
+
+void fluid_simulation::touch(glm::ivec3 pos, bool appeared) {
+    const auto coord = chunk_coord(pos);
+    auto bump = [this](glm::ivec3 chunk) {
+        if (auto it = chunks_.find(chunk); it != chunks_.end()) ++it->second.revision;
+    };
+    bump(coord);
+    if (!appeared) return;
+
+    const auto local = local_coord(pos);
+    for (int axis = 0; axis < 3; ++axis) {
+        glm::ivec3 offset{};
+        offset[axis] = 1;
+        if (local[axis] == 0) bump(coord - offset);
+        if (local[axis] == chunk_size - 1) bump(coord + offset);
+    }
+}
+
+}
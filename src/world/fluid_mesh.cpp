@@ -0,0 +1,73 @@
+#include <world/fluid_mesh.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <ranges>
+#include <utility>
+
+namespace ja {
+
+void make_fluid_mesh(const fluid_simulation& fluids, const world& world, glm::ivec3 chunk, std::vector<cube_vertex>& vertices) {
+    vertices.clear();
+    const auto* fluid = fluids.find(chunk);
+    if (fluid == nullptr) return;
+
+    const fluid_neighborhood around{fluids, world, chunk};
+    const auto origin = chunk * chunk_size;
+
+    for (std::uint32_t index = 0; index < world_chunk::volume; ++index) {
+        const int level = fluid_level((*fluid)[index]);
+        if (level == 0) continue;
+
+        const auto local = local_from_index(index);
+        const auto pos = origin + local;
+
+        // fluid that is fed from above fills the whole block
+        const float height = (around.level(pos + glm::ivec3{0, 1, 0}) > 0) ? 1.0f : level / (max_fluid_level + 1.0f);
+
+        for (auto face : cube_faces) {
+            const auto neighbor = pos + cube_face_normal(face);
+            if (around.solid(neighbor) || around.level(neighbor) > 0) continue;
+
+            std::ranges::transform(cube_face_vertices(face), std::back_inserter(vertices), [&](cube_vertex vertex) {
+                if (vertex.position.y > 0.0f) vertex.position.y = height - 0.5f;
+                vertex.position += glm::vec3{local};
+                vertex.texcoord.z = blocks::water;
+                return vertex;
+            });
+        }
+    }
+}
+
+void sort_back_to_front(std::span<const cube_vertex> vertices, glm::vec3 eye, scratch_arena& arena, std::vector<unsigned int>& indices) {
+    struct sort_key {
+        float distance{};
+        unsigned int face{};
+
+        auto operator<=>(const sort_key&) const = default;
+    };
+
+    arena.reset();
+    auto faces = arena.allocate<sort_key>(vertices.size() / 4);
+    for (unsigned int face = 0; face < faces.size(); ++face) {
+        glm::vec3 center{};
+        for (const auto& vertex : vertices.subspan(face * 4, 4)) {
+            center += vertex.position;
+        }
+        const auto offset = center / 4.0f - eye;
+        faces[face] = sort_key{glm::dot(offset, offset), face};
+    }
+
+    // farthest first, ties are broken by face so the order is stable across frames
+    std::ranges::sort(faces, std::greater{});
+
+    indices.clear();
+    for (auto face : faces | std::views::transform(&sort_key::face)) {
+        for (auto index : cube_face_indices) {
+            indices.push_back(face * 4 + index);
+        }
+    }
+}
+
+}
@@ -0,0 +1,479 @@
+#include <world/navigation.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <ranges>
+#include <span>
+#include <tuple>
+#include <utility>
+#include <world/block.h>
+
+namespace ja {
+
+namespace {
+
+constexpr std::uint32_t no_node{std::numeric_limits<std::uint32_t>::max()};
+constexpr std::uint16_t no_cell{std::numeric_limits<std::uint16_t>::max()};
+
+constexpr glm::ivec3 up{0, 1, 0};
+
+constexpr std::array<glm::ivec3, 4> directions{
+    glm::ivec3{1, 0, 0}, glm::ivec3{-1, 0, 0},
+    glm::ivec3{0, 0, 1}, glm::ivec3{0, 0, -1},
+};
+
+/**
+ * Offsets of the clusters a single move can lead into.
+ */
+constexpr std::array<glm::ivec3, 14> cluster_offsets{
+    glm::ivec3{1, -1, 0}, glm::ivec3{-1, -1, 0}, glm::ivec3{0, -1, 1}, glm::ivec3{0, -1, -1},
+    glm::ivec3{1, 0, 0}, glm::ivec3{-1, 0, 0}, glm::ivec3{0, 0, 1}, glm::ivec3{0, 0, -1},
+    glm::ivec3{1, 1, 0}, glm::ivec3{-1, 1, 0}, glm::ivec3{0, 1, 1}, glm::ivec3{0, 1, -1},
+    glm::ivec3{0, 1, 0}, glm::ivec3{0, -1, 0},
+};
+
+struct cell_flags {
+    bool walkable{};
+    bool headroom{};
+};
+
+/**
+ * Visit the cells an agent can move to from a cell, at most one per direction.
+ */
+template<typename Flags, typename F>
+void for_each_move(glm::ivec3 cell, const Flags& flags, F&& visit) {
+    const bool headroom = flags(cell).headroom;
+    for (auto direction : directions) {
+        const auto side = cell + direction;
+        if (flags(side).walkable) {
+            visit(side);
+        } else if (headroom && flags(side + up).walkable) {
+            visit(side + up);
+        } else if (const auto below = flags(side - up); below.walkable && below.headroom) {
+            visit(side - up);
+        }
+    }
+}
+
+[[nodiscard]] bool before(glm::ivec3 a, glm::ivec3 b) {
+    return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z);
+}
+
+[[nodiscard]] bool inside_chunk(glm::ivec3 local) {
+    return glm::all(glm::greaterThanEqual(local, glm::ivec3{0})) && glm::all(glm::lessThan(local, glm::ivec3{chunk_size}));
+}
+
+/**
+ * Lower bound of the number of moves between two cells.
+ */
+[[nodiscard]] std::uint32_t distance_bound(glm::ivec3 a, glm::ivec3 b) {
+    const auto d = glm::abs(a - b);
+    return static_cast<std::uint32_t>(std::max(d.x + d.z, d.y));
+}
+
+void sort_unique(std::vector<glm::ivec3>& coords) {
+    std::ranges::sort(coords, before);
+    const auto [first, last] = std::ranges::unique(coords);
+    coords.erase(first, last);
+}
+
+}
+
+void nav_graph::update(const world& world, thread_pool& pool) {
+    const auto start = std::chrono::steady_clock::now();
+    fit_scratch(pool);
+
+    std::vector<glm::ivec3> changed{};
+    for (auto coord : world.chunks()) {
+        const auto* cluster = find(coord);
+        if (cluster == nullptr || cluster->revision != world.revision(coord)) {
+            changed.push_back(coord);
+        }
+    }
+    rebuilt_ = 0;
+    if (changed.empty()) {
+        update_ms_ = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return;
+    }
+
+    // cells look at the blocks above and below them, which may be in the chunks above and below
+    std::vector<glm::ivec3> cells = changed;
+    for (auto coord : changed) {
+        for (auto neighbor : {coord + up, coord - up}) {
+            if (world.revision(neighbor) != 0) cells.push_back(neighbor);
+        }
+    }
+    sort_unique(cells);
+
+    std::vector<cluster*> targets{};
+    for (auto coord : cells) {
+        targets.push_back(&clusters_[coord]);
+    }
+
+    pool.parallel_for(cells.size(), [&](std::size_t i) {
+        const auto coord = cells[i];
+        auto& cluster = *targets[i];
+        const std::array<const world_chunk*, 3> chunks{world.find_chunk(coord - up), world.find_chunk(coord), world.find_chunk(coord + up)};
+
+        // rows -16 to 31 relative to the chunk, missing chunks are empty
+        auto solid = [&](glm::ivec3 local) {
+            const auto* chunk = chunks[static_cast<std::size_t>(floor_div(local.y, chunk_size) + 1)];
+            if (chunk == nullptr) return false;
+            const auto y = local.y - floor_div(local.y, chunk_size) * chunk_size;
+            return !is_empty((*chunk)[local.x, y, local.z]);
+        };
+
+        for (std::uint32_t index = 0; index < world_chunk::volume; ++index) {
+            const auto local = local_from_index(index);
+            cluster.walkable[index] = !solid(local) && !solid(local + up) && solid(local - up);
+            cluster.headroom[index] = !solid(local + up + up);
+        }
+        cluster.revision = world.revision(coord);
+    });
+
+    // entrances between every pair of clusters that involves one whose cells changed
+    std::vector<std::pair<glm::ivec3, glm::ivec3>> pairs{};
+    for (auto coord : cells) {
+        for (auto offset : cluster_offsets) {
+            const auto neighbor = coord + offset;
+            if (find(neighbor) == nullptr) continue;
+            pairs.push_back(before(coord, neighbor) ? std::pair{coord, neighbor} : std::pair{neighbor, coord});
+        }
+    }
+    std::ranges::sort(pairs, [](const auto& a, const auto& b) {
+        return before(a.first, b.first) || (a.first == b.first && before(a.second, b.second));
+    });
+    const auto [first, last] = std::ranges::unique(pairs);
+    pairs.erase(first, last);
+
+    for (auto [a, b] : pairs) {
+        remove_entrances(a, b);
+    }
+
+    std::vector<std::vector<std::pair<glm::ivec3, glm::ivec3>>> entrances(pairs.size());
+    pool.parallel_for(pairs.size(), [&](std::size_t i) {
+        const auto [a, b] = pairs[i];
+        const auto& from = *find(a);
+        const auto& to = *find(b);
+
+        auto flags = [&](glm::ivec3 cell) {
+            const auto coord = chunk_coord(cell);
+            const auto* cluster = (coord == a) ? &from : (coord == b) ? &to : nullptr;
+            if (cluster == nullptr) return cell_flags{};
+            const auto index = local_index(cell - coord * chunk_size);
+            return cell_flags{cluster->walkable[index], cluster->headroom[index]};
+        };
+
+        std::vector<std::pair<glm::ivec3, glm::ivec3>> moves{};
+        const auto origin = a * chunk_size;
+        for (std::uint32_t index = 0; index < world_chunk::volume; ++index) {
+            if (!from.walkable[index]) continue;
+            const auto cell = origin + local_from_index(index);
+            for_each_move(cell, flags, [&](glm::ivec3 target) {
+                if (chunk_coord(target) == b) moves.emplace_back(cell, target);
+            });
+        }
+
+        // moves from neighboring cells belong to the same entrance, which is crossed in its middle
+        std::vector<std::size_t> component(moves.size());
+        std::iota(component.begin(), component.end(), 0uz);
+        auto root = [&](std::size_t move) {
+            while (component[move] != move) move = component[move] = component[component[move]];
+            return move;
+        };
+        for (std::size_t i = 0; i < moves.size(); ++i) {
+            for (std::size_t j = i + 1; j < moves.size(); ++j) {
+                const auto d = glm::abs(moves[i].first - moves[j].first);
+                if (d.x + d.y + d.z == 1) component[root(j)] = root(i);
+            }
+        }
+
+        std::vector<std::vector<std::size_t>> members(moves.size());
+        for (std::size_t i = 0; i < moves.size(); ++i) {
+            members[root(i)].push_back(i);
+        }
+        for (const auto& group : members) {
+            if (!group.empty()) entrances[i].push_back(moves[group[group.size() / 2]]);
+        }
+    });
+
+    auto allocate = [this](glm::ivec3 cell) {
+        std::uint32_t id{};
+        if (free_nodes_.empty()) {
+            id = static_cast<std::uint32_t>(nodes_.size());
+            nodes_.emplace_back();
+        } else {
+            id = free_nodes_.back();
+            free_nodes_.pop_back();
+        }
+        nodes_[id].cell = cell;
+        nodes_[id].edges.clear();
+        nodes_[id].steps.clear();
+        return id;
+    };
+
+    std::vector<glm::ivec3> connect_clusters = cells;
+    for (auto [pair, found] : std::views::zip(pairs, entrances)) {
+        for (auto [from, to] : found) {
+            const auto a = allocate(from);
+            const auto b = allocate(to);
+            nodes_[a].partner = b;
+            nodes_[b].partner = a;
+            clusters_[pair.first].nodes.push_back(a);
+            clusters_[pair.second].nodes.push_back(b);
+        }
+        connect_clusters.push_back(pair.first);
+        connect_clusters.push_back(pair.second);
+    }
+    sort_unique(connect_clusters);
+
+    pool.parallel_for(connect_clusters.size(), [&](std::size_t i) {
+        connect(*find(connect_clusters[i]), connect_clusters[i], scratch_[pool.current_worker()]);
+    });
+
+    rebuilt_ = connect_clusters.size();
+    update_ms_ = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool nav_graph::walkable(glm::ivec3 cell) const {
+    const auto coord = chunk_coord(cell);
+    const auto* cluster = find(coord);
+    return cluster != nullptr && cluster->walkable[local_index(cell - coord * chunk_size)];
+}
+
+bool nav_graph::find_path(const nav_query& query, nav_path& path) {
+    return find_path(scratch_.back(), query, path);
+}
+
+void nav_graph::find_paths(thread_pool& pool, std::span<const nav_query> queries, std::span<nav_path> paths) {
+    fit_scratch(pool);
+    pool.parallel_for(queries.size(), [&](std::size_t i) {
+        find_path(scratch_[pool.current_worker()], queries[i], paths[i]);
+    });
+}
+
+void nav_graph::fit_scratch(const thread_pool& pool) {
+    // workers are numbered from 0 and the calling thread comes after them
+    if (scratch_.size() < pool.size() + 1) scratch_.resize(pool.size() + 1);
+}
+
+nav_stats nav_graph::stats() const {
+    nav_stats stats{
+        .clusters = clusters_.size(),
+        .nodes = nodes_.size() - free_nodes_.size(),
+        .rebuilt = rebuilt_,
+        .update_ms = update_ms_,
+    };
+    for (const auto& cluster : clusters_ | std::views::values) {
+        for (auto id : cluster.nodes) {
+            stats.edges += nodes_[id].edges.size();
+        }
+    }
+    return stats;
+}
+
+const nav_graph::cluster* nav_graph::find(glm::ivec3 coord) const {
+    auto it = clusters_.find(coord);
+    return (it != clusters_.end()) ? &it->second : nullptr;
+}
+
+void nav_graph::search_cluster(scratch& scratch, const cluster& cluster, glm::ivec3 coord, glm::ivec3 start, const glm::ivec3* target) const {
+    if (scratch.cell_visited.empty()) {
+        scratch.cell_cost.resize(world_chunk::volume);
+        scratch.cell_parent.resize(world_chunk::volume);
+        scratch.cell_visited.resize(world_chunk::volume);
+        scratch.queue.reserve(world_chunk::volume);
+    }
+    const auto generation = ++scratch.cell_generation;
+    const auto origin = coord * chunk_size;
+
+    auto flags = [&](glm::ivec3 cell) {
+        const auto local = cell - origin;
+        if (!inside_chunk(local)) return cell_flags{};
+        const auto index = local_index(local);
+        return cell_flags{cluster.walkable[index], cluster.headroom[index]};
+    };
+
+    const auto first = static_cast<std::uint16_t>(local_index(start - origin));
+    scratch.queue.clear();
+    scratch.queue.push_back(first);
+    scratch.cell_visited[first] = generation;
+    scratch.cell_cost[first] = 0;
+    scratch.cell_parent[first] = no_cell;
+
+    const auto goal = (target != nullptr) ? local_index(*target - origin) : world_chunk::volume;
+    for (std::size_t next = 0; next < scratch.queue.size(); ++next) {
+        const auto index = scratch.queue[next];
+        if (index == goal) return;
+
+        const auto cost = static_cast<std::uint16_t>(scratch.cell_cost[index] + 1);
+        for_each_move(origin + local_from_index(index), flags, [&](glm::ivec3 cell) {
+            const auto neighbor = static_cast<std::uint16_t>(local_index(cell - origin));
+            if (scratch.cell_visited[neighbor] == generation) return;
+            scratch.cell_visited[neighbor] = generation;
+            scratch.cell_cost[neighbor] = cost;
+            scratch.cell_parent[neighbor] = index;
+            scratch.queue.push_back(neighbor);
+        });
+    }
+}
+
+bool nav_graph::find_path(scratch& scratch, const nav_query& query, nav_path& path) const {
+    path.clear();
+
+    const auto start_coord = chunk_coord(query.start);
+    const auto goal_coord = chunk_coord(query.goal);
+    const auto* start_cluster = find(start_coord);
+    const auto* goal_cluster = find(goal_coord);
+    if (!walkable(query.start) || !walkable(query.goal)) return false;
+
+    auto reached = [&](glm::ivec3 cell, glm::ivec3 coord) {
+        return scratch.cell_visited[local_index(cell - coord * chunk_size)] == scratch.cell_generation;
+    };
+
+    // a path within the cluster is good enough if there is one
+    if (start_coord == goal_coord) {
+        search_cluster(scratch, *start_cluster, start_coord, query.start, &query.goal);
+        if (reached(query.goal, goal_coord)) {
+            path.push_back(query.start);
+            append_cluster_path(scratch, start_coord * chunk_size, query.goal, path);
+            return true;
+        }
+    }
+
+    if (scratch.cost.size() < nodes_.size()) {
+        scratch.cost.resize(nodes_.size());
+        scratch.parent.resize(nodes_.size());
+        scratch.visited.resize(nodes_.size());
+        scratch.goal_cost.resize(nodes_.size());
+        scratch.goal_visited.resize(nodes_.size());
+    }
+    const auto generation = ++scratch.generation;
+
+    // moves are reversible, so the distances from the goal are the distances to it
+    search_cluster(scratch, *goal_cluster, goal_coord, query.goal, nullptr);
+    for (auto id : goal_cluster->nodes) {
+        if (!reached(nodes_[id].cell, goal_coord)) continue;
+        scratch.goal_cost[id] = scratch.cell_cost[local_index(nodes_[id].cell - goal_coord * chunk_size)];
+        scratch.goal_visited[id] = generation;
+    }
+
+    using entry = std::pair<std::uint32_t, std::uint32_t>;
+    std::vector<entry> open{};
+    auto push = [&](std::uint32_t id, std::uint32_t cost, std::uint32_t parent) {
+        scratch.cost[id] = cost;
+        scratch.parent[id] = parent;
+        scratch.visited[id] = generation;
+        open.emplace_back(cost + distance_bound(nodes_[id].cell, query.goal), id);
+        std::ranges::push_heap(open, std::greater{});
+    };
+
+    // the start cluster search stays in the scratch until the path is refined
+    search_cluster(scratch, *start_cluster, start_coord, query.start, nullptr);
+    for (auto id : start_cluster->nodes) {
+        if (!reached(nodes_[id].cell, start_coord)) continue;
+        push(id, scratch.cell_cost[local_index(nodes_[id].cell - start_coord * chunk_size)], no_node);
+    }
+
+    auto best = std::numeric_limits<std::uint32_t>::max();
+    auto last = no_node;
+    while (!open.empty()) {
+        std::ranges::pop_heap(open, std::greater{});
+        const auto [estimate, id] = open.back();
+        open.pop_back();
+        if (estimate >= best) break;
+        if (estimate > scratch.cost[id] + distance_bound(nodes_[id].cell, query.goal)) continue;
+
+        if (scratch.goal_visited[id] == generation && scratch.cost[id] + scratch.goal_cost[id] < best) {
+            best = scratch.cost[id] + scratch.goal_cost[id];
+            last = id;
+        }
+
+        for (const auto& edge : nodes_[id].edges) {
+            const auto total = scratch.cost[id] + edge.cost;
+            if (scratch.visited[edge.to] == generation && scratch.cost[edge.to] <= total) continue;
+            push(edge.to, total, id);
+        }
+    }
+    if (last == no_node) return false;
+
+    std::vector<std::uint32_t> abstract{};
+    for (auto id = last; id != no_node; id = scratch.parent[id]) {
+        abstract.push_back(id);
+    }
+    std::ranges::reverse(abstract);
+
+    path.push_back(query.start);
+    append_cluster_path(scratch, start_coord * chunk_size, nodes_[abstract.front()].cell, path);
+
+    for (auto [from, to] : abstract | std::views::pairwise) {
+        const auto& target = nodes_[to].cell;
+        if (nodes_[from].partner == to) {
+            path.push_back(target);
+            continue;
+        }
+        const auto& node = nodes_[from];
+        const auto origin = chunk_coord(node.cell) * chunk_size;
+        const auto edge = std::ranges::find(node.edges, to, &edge::to);
+        for (auto index : std::span{node.steps}.subspan(edge->first, edge->cost)) {
+            path.push_back(origin + local_from_index(index));
+        }
+    }
+
+    search_cluster(scratch, *goal_cluster, goal_coord, nodes_[abstract.back()].cell, &query.goal);
+    append_cluster_path(scratch, goal_coord * chunk_size, query.goal, path);
+    return true;
+}
+
+void nav_graph::append_cluster_path(const scratch& scratch, glm::ivec3 origin, glm::ivec3 cell, nav_path& path) {
+    const auto size = path.size();
+    for (auto index = static_cast<std::uint16_t>(local_index(cell - origin)); scratch.cell_parent[index] != no_cell; index = scratch.cell_parent[index]) {
+        path.push_back(origin + local_from_index(index));
+    }
+    std::reverse(path.begin() + static_cast<std::ptrdiff_t>(size), path.end());
+}
+
+void nav_graph::remove_entrances(glm::ivec3 a, glm::ivec3 b) {
+    auto& first = clusters_[a];
+    auto& second = clusters_[b];
+
+    auto across = [this](glm::ivec3 coord) {
+        return [this, coord](std::uint32_t id) { return chunk_coord(nodes_[nodes_[id].partner].cell) == coord; };
+    };
+
+    for (auto id : first.nodes | std::views::filter(across(b))) {
+        free_nodes_.push_back(id);
+        free_nodes_.push_back(nodes_[id].partner);
+    }
+    std::erase_if(first.nodes, across(b));
+    std::erase_if(second.nodes, across(a));
+}
+
+void nav_graph::connect(const cluster& cluster, glm::ivec3 coord, scratch& scratch) {
+    const auto origin = coord * chunk_size;
+    for (auto id : cluster.nodes) {
+        auto& node = nodes_[id];
+        node.edges.clear();
+        node.steps.clear();
+        node.edges.push_back(edge{node.partner, 1});
+
+        search_cluster(scratch, cluster, coord, node.cell, nullptr);
+        for (auto other : cluster.nodes) {
+            const auto index = local_index(nodes_[other].cell - origin);
+            if (other == id || scratch.cell_visited[index] != scratch.cell_generation) continue;
+
+            const auto first = static_cast<std::uint32_t>(node.steps.size());
+            for (auto step = static_cast<std::uint16_t>(index); scratch.cell_parent[step] != no_cell; step = scratch.cell_parent[step]) {
+                node.steps.push_back(step);
+            }
+            std::reverse(node.steps.begin() + first, node.steps.end());
+            node.edges.push_back(edge{other, scratch.cell_cost[index], first});
+        }
+    }
+}
+
+}
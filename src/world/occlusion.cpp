@@ -0,0 +1,238 @@
+#include <world/occlusion.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <experimental/simd>
+#include <limits>
+#include <ranges>
+
+namespace ja {
+
+namespace {
+
+namespace stdx = std::experimental;
+
+using float_simd = stdx::native_simd<float>;
+
+/**
+ * Clip space w below which a vertex is considered to be behind the camera.
+ */
+constexpr float min_w{1e-4f};
+
+constexpr std::size_t row_alignment{16};
+
+static_assert(row_alignment % float_simd::size() == 0);
+
+[[nodiscard]] float elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+occlusion_culler::occlusion_culler(std::size_t width, std::size_t height)
+    :width_{(width + row_alignment - 1) / row_alignment * row_alignment}, height_{height} {
+    glm::ivec2 size{width_, height_};
+    while (true) {
+        level_sizes_.push_back(size);
+        levels_.emplace_back(static_cast<std::size_t>(size.x * size.y), 1.0f);
+        if (size.x == 1 && size.y == 1) break;
+        size = glm::ivec2{(size.x + 1) / 2, (size.y + 1) / 2};
+    }
+}
+
+void occlusion_culler::begin(const glm::mat4& view_proj) {
+    view_proj_ = view_proj;
+    triangles_.clear();
+    stats_ = {};
+}
+
+void occlusion_culler::add_occluder(const occluder& quad) {
+    std::array<glm::vec3, 4> screen{};
+    for (auto [corner, point] : std::views::zip(quad, screen)) {
+        const glm::vec4 clip = view_proj_ * glm::vec4{corner, 1.0f};
+
+        // clipping isn't worth it, skipping an occluder is always safe
+        if (clip.w < min_w) return;
+
+        const glm::vec3 ndc = glm::vec3{clip} / clip.w;
+        point = glm::vec3{
+            (ndc.x * 0.5f + 0.5f) * width_,
+            (ndc.y * 0.5f + 0.5f) * height_,
+            ndc.z * 0.5f + 0.5f,
+        };
+    }
+
+    ++stats_.occluders;
+    add_triangle(screen[0], screen[1], screen[2]);
+    add_triangle(screen[0], screen[2], screen[3]);
+}
+
+void occlusion_culler::add_triangle(glm::vec3 a, glm::vec3 b, glm::vec3 c) {
+    float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    if (std::abs(area) < 1e-6f) return;
+    if (area < 0.0f) {
+        std::swap(b, c);
+        area = -area;
+    }
+
+    // edge function of the edge from p to q, positive on the inside
+    auto edge = [](glm::vec3 p, glm::vec3 q) {
+        const float dx = -(q.y - p.y);
+        const float dy = q.x - p.x;
+        return glm::vec3{dx, dy, -(dx * p.x + dy * p.y)};
+    };
+
+    triangle tri{};
+    tri.edges = {edge(b, c), edge(c, a), edge(a, b)};
+
+    // depth is affine in screen space, weighted by the opposite edges
+    tri.plane = (tri.edges[0] * a.z + tri.edges[1] * b.z + tri.edges[2] * c.z) / area;
+    tri.depth_margin = 0.5f * (std::abs(tri.plane.x) + std::abs(tri.plane.y));
+
+    tri.min_x = std::max(static_cast<int>(std::floor(std::min({a.x, b.x, c.x}))), 0);
+    tri.max_x = std::min(static_cast<int>(std::ceil(std::max({a.x, b.x, c.x}))), static_cast<int>(width_));
+    tri.min_y = std::max(static_cast<int>(std::floor(std::min({a.y, b.y, c.y}))), 0);
+    tri.max_y = std::min(static_cast<int>(std::ceil(std::max({a.y, b.y, c.y}))), static_cast<int>(height_));
+
+    if (tri.min_x >= tri.max_x || tri.min_y >= tri.max_y) return;
+
+    tri.min_x -= tri.min_x % static_cast<int>(float_simd::size());
+    triangles_.push_back(tri);
+}
+
+void occlusion_culler::rasterize(thread_pool& pool) {
+    const auto start = std::chrono::steady_clock::now();
+
+    const std::size_t tile_count = (height_ + tile_height - 1) / tile_height;
+    pool.parallel_for(tile_count, [this](std::size_t tile) {
+        rasterize_tile(tile);
+    });
+    build_hierarchy();
+
+    stats_.raster_ms = elapsed_ms(start);
+}
+
+void occlusion_culler::rasterize_tile(std::size_t tile) {
+    const int tile_min_y = static_cast<int>(tile * tile_height);
+    const int tile_max_y = std::min(tile_min_y + static_cast<int>(tile_height), static_cast<int>(height_));
+
+    auto& depth = levels_.front();
+    std::fill(depth.begin() + tile_min_y * width_, depth.begin() + tile_max_y * width_, 1.0f);
+
+    const float_simd lanes([](auto i) { return static_cast<float>(i); });
+
+    for (const auto& tri : triangles_) {
+        const int min_y = std::max(tri.min_y, tile_min_y);
+        const int max_y = std::min(tri.max_y, tile_max_y);
+
+        // a pixel only counts as covered when its whole area is inside all edges
+        std::array<float, 3> margins{};
+        for (auto [margin, edge] : std::views::zip(margins, tri.edges)) {
+            margin = 0.5f * (std::abs(edge.x) + std::abs(edge.y));
+        }
+
+        for (int y = min_y; y < max_y; ++y) {
+            const float py = static_cast<float>(y) + 0.5f;
+            float* row = depth.data() + y * width_;
+
+            for (int x = tri.min_x; x < tri.max_x; x += static_cast<int>(float_simd::size())) {
+                const float_simd px = lanes + (static_cast<float>(x) + 0.5f);
+
+                auto inside = (px * tri.edges[0].x + (py * tri.edges[0].y + tri.edges[0].z)) >= margins[0];
+                inside = inside && (px * tri.edges[1].x + (py * tri.edges[1].y + tri.edges[1].z)) >= margins[1];
+                inside = inside && (px * tri.edges[2].x + (py * tri.edges[2].y + tri.edges[2].z)) >= margins[2];
+                if (stdx::none_of(inside)) continue;
+
+                // farthest depth within each pixel
+                const float_simd z = stdx::clamp(px * tri.plane.x + (py * tri.plane.y + tri.plane.z + tri.depth_margin), float_simd{0.0f}, float_simd{1.0f});
+
+                float_simd current{row + x, stdx::element_aligned};
+                stdx::where(inside, current) = stdx::min(current, z);
+                current.copy_to(row + x, stdx::element_aligned);
+            }
+        }
+    }
+}
+
+void occlusion_culler::build_hierarchy() {
+    for (std::size_t level = 1; level < levels_.size(); ++level) {
+        const auto& src = levels_[level - 1];
+        const auto src_size = level_sizes_[level - 1];
+        auto& dst = levels_[level];
+        const auto dst_size = level_sizes_[level];
+
+        for (int y = 0; y < dst_size.y; ++y) {
+            for (int x = 0; x < dst_size.x; ++x) {
+                const int x0 = 2 * x, x1 = std::min(2 * x + 1, src_size.x - 1);
+                const int y0 = 2 * y, y1 = std::min(2 * y + 1, src_size.y - 1);
+                dst[y * dst_size.x + x] = std::max({
+                    src[y0 * src_size.x + x0], src[y0 * src_size.x + x1],
+                    src[y1 * src_size.x + x0], src[y1 * src_size.x + x1],
+                });
+            }
+        }
+    }
+}
+
+void occlusion_culler::test(std::span<const aabb> boxes, std::span<std::uint8_t> visible) {
+    const auto start = std::chrono::steady_clock::now();
+
+    for (auto [box, result] : std::views::zip(boxes, visible)) {
+        result = this->visible(box);
+        ++stats_.tested;
+        stats_.culled += !result;
+    }
+
+    stats_.test_ms = elapsed_ms(start);
+}
+
+bool occlusion_culler::visible(const aabb& box) const {
+    glm::vec2 min{std::numeric_limits<float>::max()};
+    glm::vec2 max{std::numeric_limits<float>::lowest()};
+    float nearest{std::numeric_limits<float>::max()};
+
+    for (int corner = 0; corner < 8; ++corner) {
+        const glm::vec3 point{
+            (corner & 1) ? box.max.x : box.min.x,
+            (corner & 2) ? box.max.y : box.min.y,
+            (corner & 4) ? box.max.z : box.min.z,
+        };
+        const glm::vec4 clip = view_proj_ * glm::vec4{point, 1.0f};
+
+        // the box crosses the near plane
+        if (clip.w < min_w) return true;
+
+        const glm::vec3 ndc = glm::vec3{clip} / clip.w;
+        min = glm::min(min, glm::vec2{ndc});
+        max = glm::max(max, glm::vec2{ndc});
+        nearest = std::min(nearest, ndc.z * 0.5f + 0.5f);
+    }
+
+    if (max.x < -1.0f || min.x > 1.0f || max.y < -1.0f || min.y > 1.0f || nearest > 1.0f) {
+        return false;
+    }
+
+    if (nearest <= 0.0f) return true;
+
+    const glm::vec2 size{width_, height_};
+    const glm::ivec2 lo = glm::clamp(glm::ivec2{glm::floor((min * 0.5f + 0.5f) * size)}, glm::ivec2{0}, glm::ivec2{size} - 1);
+    const glm::ivec2 hi = glm::clamp(glm::ivec2{glm::floor((max * 0.5f + 0.5f) * size)}, glm::ivec2{0}, glm::ivec2{size} - 1);
+
+    // pick the level at which the box covers at most 4 x 4 texels
+    std::size_t level = 0;
+    while (level + 1 < levels_.size() && std::max(hi.x - lo.x, hi.y - lo.y) >> level >= 4) {
+        ++level;
+    }
+
+    const auto& depth = levels_[level];
+    const auto level_size = level_sizes_[level];
+    for (int y = lo.y >> level; y <= hi.y >> level; ++y) {
+        for (int x = lo.x >> level; x <= hi.x >> level; ++x) {
+            if (nearest < depth[y * level_size.x + x]) return true;
+        }
+    }
+
+    return false;
+}
+
+}
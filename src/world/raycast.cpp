@@ -0,0 +1,91 @@
+#include <world/raycast.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace ja {
+
+std::optional<ray_entry> enter_box(glm::vec3 origin, glm::vec3 direction, glm::vec3 size) {
+    constexpr auto infinity = std::numeric_limits<float>::infinity();
+
+    ray_entry entry{};
+    float exit{infinity};
+    bool inside{true};
+
+    for (int axis{}; axis < 3; ++axis) {
+        const bool outside = origin[axis] < 0.0f || origin[axis] > size[axis];
+        inside = inside && !outside;
+
+        if (direction[axis] == 0.0f) {
+            if (outside) return std::nullopt;
+            continue;
+        }
+
+        const auto near = (0.0f - origin[axis]) / direction[axis];
+        const auto far = (size[axis] - origin[axis]) / direction[axis];
+        const auto enter = std::min(near, far);
+        if (enter > entry.distance) entry = {enter, axis};
+        exit = std::min(exit, std::max(near, far));
+    }
+
+    if (entry.distance > exit) return std::nullopt;
+
+    if (inside) {
+        const auto magnitude = glm::abs(direction);
+        entry = {0.0f, magnitude.x >= magnitude.y && magnitude.x >= magnitude.z ? 0 : magnitude.y >= magnitude.z ? 1 : 2};
+    }
+
+    return entry;
+}
+
+grid_walk::grid_walk(glm::vec3 origin, glm::vec3 direction, float cell_size, ray_entry start, glm::ivec3 min_cell, glm::ivec3 max_cell)
+    : min_cell_{min_cell}, max_cell_{max_cell}, distance_{start.distance}, axis_{start.axis} {
+    constexpr auto infinity = std::numeric_limits<float>::infinity();
+    const auto position = (origin + direction * start.distance) / cell_size;
+
+    for (int axis{}; axis < 3; ++axis) {
+        // on a cell boundary, pick the cell the ray moves into
+        const auto cell = direction[axis] < 0.0f ? std::ceil(position[axis]) - 1.0f : std::floor(position[axis]);
+        cell_[axis] = std::clamp(static_cast<int>(cell), min_cell[axis], max_cell[axis]);
+
+        if (direction[axis] > 0.0f) {
+            step_[axis] = 1;
+            delta_distance_[axis] = cell_size / direction[axis];
+            next_distance_[axis] = start.distance + (static_cast<float>(cell_[axis] + 1) - position[axis]) * delta_distance_[axis];
+        } else if (direction[axis] < 0.0f) {
+            step_[axis] = -1;
+            delta_distance_[axis] = cell_size / -direction[axis];
+            next_distance_[axis] = start.distance + (position[axis] - static_cast<float>(cell_[axis])) * delta_distance_[axis];
+        } else {
+            step_[axis] = 0;
+            delta_distance_[axis] = infinity;
+            next_distance_[axis] = infinity;
+        }
+    }
+}
+
+void grid_walk::next() {
+    axis_ = next_distance_.x < next_distance_.y
+        ? (next_distance_.x < next_distance_.z ? 0 : 2)
+        : (next_distance_.y < next_distance_.z ? 1 : 2);
+
+    cell_[axis_] += step_[axis_];
+    distance_ = next_distance_[axis_];
+    next_distance_[axis_] += delta_distance_[axis_];
+}
+
+cube_face grid_walk::entered() const {
+    // the ray enters through the side facing back along its direction
+    const bool positive = step_[axis_] > 0;
+    switch (axis_) {
+        case 0:
+            return positive ? cube_face::left : cube_face::right;
+        case 1:
+            return positive ? cube_face::bottom : cube_face::top;
+        default:
+            return positive ? cube_face::back : cube_face::front;
+    }
+}
+
+}
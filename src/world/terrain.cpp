@@ -0,0 +1,122 @@
+#include <world/terrain.h>
+#include <cmath>
+#include <vector>
+
+namespace ja {
+
+namespace {
+
+[[nodiscard]] std::uint32_t hash(std::uint32_t seed, int x, int y, int z) {
+    std::uint32_t h = seed;
+    h ^= static_cast<std::uint32_t>(x) * 0x8da6b343u;
+    h ^= static_cast<std::uint32_t>(y) * 0xd8163841u;
+    h ^= static_cast<std::uint32_t>(z) * 0xcb1ab31fu;
+    h ^= h >> 16;
+    h *= 0x7feb352du;
+    h ^= h >> 15;
+    h *= 0x846ca68bu;
+    h ^= h >> 16;
+    return h;
+}
+
+/**
+ * Obtain a random value in [0, 1] at a lattice point.
+ */
+[[nodiscard]] float lattice(std::uint32_t seed, int x, int y, int z) {
+    return static_cast<float>(hash(seed, x, y, z)) / static_cast<float>(0xffffffffu);
+}
+
+[[nodiscard]] float smooth(float t) {
+    return t * t * (3.0f - 2.0f * t);
+}
+
+/**
+ * Trilinearly interpolated value noise in [0, 1].
+ */
+[[nodiscard]] float value_noise(std::uint32_t seed, glm::vec3 p) {
+    const glm::vec3 floor = glm::floor(p);
+    const glm::ivec3 i{floor};
+    const glm::vec3 f = p - floor;
+    const glm::vec3 t{smooth(f.x), smooth(f.y), smooth(f.z)};
+
+    auto at = [&](int dx, int dy, int dz) {
+        return lattice(seed, i.x + dx, i.y + dy, i.z + dz);
+    };
+
+    const float x00 = std::lerp(at(0, 0, 0), at(1, 0, 0), t.x);
+    const float x10 = std::lerp(at(0, 1, 0), at(1, 1, 0), t.x);
+    const float x01 = std::lerp(at(0, 0, 1), at(1, 0, 1), t.x);
+    const float x11 = std::lerp(at(0, 1, 1), at(1, 1, 1), t.x);
+    return std::lerp(std::lerp(x00, x10, t.y), std::lerp(x01, x11, t.y), t.z);
+}
+
+/**
+ * Sum of a few octaves of value noise, normalized to [0, 1].
+ */
+[[nodiscard]] float fractal_noise(std::uint32_t seed, glm::vec3 p, int octaves = 4) {
+    float sum{}, amplitude{1.0f}, total{};
+    for (int octave = 0; octave < octaves; ++octave) {
+        sum += value_noise(seed + octave, p) * amplitude;
+        total += amplitude;
+        amplitude *= 0.5f;
+        p = p * 2.0f;
+    }
+    return sum / total;
+}
+
+}
+
+int terrain_height(int x, int z, const terrain_params& params) {
+    const float noise = fractal_noise(params.seed, glm::vec3{x, 0, z} * params.scale);
+    return params.base_height + static_cast<int>(noise * params.amplitude);
+}
+
+void generate_terrain(world& world, glm::ivec3 min_chunk, glm::ivec3 max_chunk, thread_pool& pool, const terrain_params& params) {
+    // chunks are created up front, as creating them isn't thread-safe
+    std::vector<std::pair<glm::ivec3, world_chunk*>> chunks{};
+    for (int x = min_chunk.x; x < max_chunk.x; ++x) {
+        for (int y = min_chunk.y; y < max_chunk.y; ++y) {
+            for (int z = min_chunk.z; z < max_chunk.z; ++z) {
+                chunks.emplace_back(glm::ivec3{x, y, z}, &world.chunk_at({x, y, z}));
+            }
+        }
+    }
+
+    pool.parallel_for(chunks.size(), [&](std::size_t index) {
+        auto [coord, chunk] = chunks[index];
+        const glm::ivec3 origin = coord * chunk_size;
+
+        for (int i = 0; i < chunk_size; ++i) {
+            for (int k = 0; k < chunk_size; ++k) {
+                const int height = terrain_height(origin.x + i, origin.z + k, params);
+
+                for (int j = 0; j < chunk_size; ++j) {
+                    const glm::ivec3 pos = origin + glm::ivec3{i, j, k};
+
+                    int block = blocks::empty;
+                    if (pos.y == height) {
+                        block = blocks::grass;
+                    } else if (pos.y < height) {
+                        block = blocks::dirt;
+                    }
+
+                    // carve caves, leaving a crust below the surface
+                    if (!is_empty(block) && pos.y < height - 3) {
+                        const float cave = fractal_noise(params.seed ^ 0xca7eu, glm::vec3{pos} * params.cave_scale, 2);
+                        if (cave > params.cave_threshold) {
+                            block = blocks::empty;
+                        }
+                    }
+
+                    (*chunk)[i, j, k] = block;
+                }
+            }
+        }
+    });
+
+    for (auto [coord, _] : chunks) {
+        world.invalidate(coord);
+    }
+}
+
+}
@@ -0,0 +1,261 @@
+#include <world/tick_scheduler.h>
+
+#include <algorithm>
+#include <chrono>
+#include <ranges>
+#include <tuple>
+#include <utility>
+#include <world/block.h>
+
+namespace ja {
+
+namespace {
+
+constexpr std::uint32_t chunk_volume{chunk_size * chunk_size * chunk_size};
+
+[[nodiscard]] const tick_handler* find_handler(const std::vector<tick_handler>& handlers, int block) {
+    if (block < 0 || static_cast<std::size_t>(block) >= handlers.size()) return nullptr;
+    const auto& handler = handlers[static_cast<std::size_t>(block)];
+    return handler ? &handler : nullptr;
+}
+
+void set_handler(std::vector<tick_handler>& handlers, int block, tick_handler handler) {
+    if (block < 0) return;
+    if (static_cast<std::size_t>(block) >= handlers.size()) {
+        handlers.resize(static_cast<std::size_t>(block) + 1);
+    }
+    handlers[static_cast<std::size_t>(block)] = std::move(handler);
+}
+
+void push(chunk_ticks& ticks, std::uint64_t now, std::uint32_t index, int block, std::uint32_t delay) {
+    ticks.queue.push(scheduled_tick{
+        .tick = now + std::max(delay, 1u),
+        .order = ticks.next_order++,
+        .index = index,
+        .block = block,
+    });
+}
+
+/**
+ * Chunks whose coordinates have the same parity are at least two chunks apart.
+ */
+[[nodiscard]] std::size_t phase(glm::ivec3 coord) {
+    return static_cast<std::size_t>((coord.x & 1) | (coord.y & 1) << 1 | (coord.z & 1) << 2);
+}
+
+}
+
+void tick_context::reset(world& world, glm::ivec3 coord, chunk_ticks& ticks, std::uint64_t tick, std::uint64_t seed) {
+    world_ = &world;
+    coord_ = coord;
+    ticks_ = &ticks;
+    tick_ = tick;
+    random_ = seed ^ ivec3_hash{}(coord) ^ tick * 0xd1b54a32d192ed03u;
+    chunk_ = nullptr;
+    looked_up_ = 0;
+    changed_ = false;
+    scheduled_count_ = 0;
+    random_count_ = 0;
+    blocks_.clear();
+    scheduled_.clear();
+    edits_.clear();
+}
+
+int tick_context::get_block(glm::ivec3 pos) const {
+    const auto offset = chunk_coord(pos) - coord_;
+    if (glm::any(glm::greaterThan(glm::abs(offset), glm::ivec3{1}))) return blocks::empty;
+
+    const auto slot = static_cast<std::size_t>((offset.x + 1) * 9 + (offset.y + 1) * 3 + offset.z + 1);
+    if ((looked_up_ & (1u << slot)) == 0) {
+        neighbors_[slot] = std::as_const(*world_).find_chunk(coord_ + offset);
+        looked_up_ |= 1u << slot;
+    }
+
+    const auto* chunk = neighbors_[slot];
+    if (chunk == nullptr) return blocks::empty;
+
+    const auto local = local_coord(pos);
+    return (*chunk)[local.x, local.y, local.z];
+}
+
+void tick_context::set_block(glm::ivec3 pos, int block) {
+    if (chunk_coord(pos) != coord_) {
+        blocks_.push_back(deferred_block{pos, block});
+        return;
+    }
+
+    // only this context touches its chunk during the phase, so it can be made writable here
+    if (chunk_ == nullptr) {
+        constexpr std::size_t center{13};
+        chunk_ = world_->find_chunk(coord_);
+        neighbors_[center] = chunk_;
+        looked_up_ |= 1u << center;
+    }
+
+    const auto local = local_coord(pos);
+    auto& slot = (*chunk_)[local.x, local.y, local.z];
+    if (slot != block) {
+        if (world_->journal() != nullptr) edits_.add(coord_, local_index(local), slot, block);
+        slot = block;
+        changed_ = true;
+    }
+}
+
+void tick_context::schedule(glm::ivec3 pos, std::uint32_t delay) {
+    if (chunk_coord(pos) != coord_) {
+        scheduled_.push_back(deferred_tick{pos, delay});
+        return;
+    }
+    push(*ticks_, tick_, local_index(local_coord(pos)), get_block(pos), delay);
+}
+
+std::uint32_t tick_context::random() {
+    // splitmix64
+    random_ += 0x9e3779b97f4a7c15u;
+    auto z = random_;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9u;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebu;
+    return static_cast<std::uint32_t>((z ^ (z >> 31)) >> 32);
+}
+
+void tick_scheduler::on_scheduled(int block, tick_handler handler) {
+    set_handler(scheduled_handlers_, block, std::move(handler));
+}
+
+void tick_scheduler::on_random(int block, tick_handler handler) {
+    set_handler(random_handlers_, block, std::move(handler));
+    // counts are only kept while there are random handlers, so recount all chunks
+    for (auto& ticks : chunks_ | std::views::values) {
+        ticks.revision = 0;
+    }
+}
+
+void tick_scheduler::schedule(const world& world, glm::ivec3 pos, std::uint32_t delay) {
+    const auto coord = chunk_coord(pos);
+    if (world.revision(coord) == 0) return;
+    push(chunks_[coord], tick_, local_index(local_coord(pos)), world.get_block(pos), delay);
+}
+
+std::size_t tick_scheduler::pending() const {
+    std::size_t count{};
+    for (const auto& ticks : chunks_ | std::views::values) {
+        count += ticks.queue.size();
+    }
+    return count;
+}
+
+void tick_scheduler::tick(world& world, thread_pool& pool) {
+    const auto start = std::chrono::steady_clock::now();
+    ++tick_;
+    stats_ = {};
+
+    count_random_blocks(world, pool);
+
+    auto* journal = world.journal();
+    if (journal != nullptr) journal->begin_batch();
+
+    for (auto& chunks : phases_) chunks.clear();
+    for (auto& [coord, ticks] : chunks_) {
+        const bool due = !ticks.queue.empty() && ticks.queue.top().tick <= tick_;
+        if (!due && ticks.random_blocks == 0) continue;
+        phases_[phase(coord)].push_back(active_chunk{coord, &ticks});
+    }
+
+    for (auto& chunks : phases_) {
+        // hash map order depends on history, a fixed order keeps changes across chunks deterministic
+        std::ranges::sort(chunks, {}, [](const active_chunk& chunk) {
+            return std::tuple{chunk.coord.x, chunk.coord.y, chunk.coord.z};
+        });
+        if (contexts_.size() < chunks.size()) contexts_.resize(chunks.size());
+
+        pool.parallel_for(chunks.size(), [&](std::size_t i) {
+            auto& context = contexts_[i];
+            context.reset(world, chunks[i].coord, *chunks[i].ticks, tick_, seed_);
+            run(context);
+        });
+
+        for (auto& context : contexts_ | std::views::take(chunks.size())) {
+            stats_.scheduled += context.scheduled_count_;
+            stats_.random += context.random_count_;
+            if (context.changed_) world.invalidate(context.coord_);
+            if (journal != nullptr) journal->commit(context.edits_);
+
+            for (auto [pos, block] : context.blocks_) {
+                const auto coord = chunk_coord(pos);
+                if (is_empty(block) && world.revision(coord) == 0) continue;
+
+                const auto local = local_coord(pos);
+                auto& slot = world.chunk_at(coord)[local.x, local.y, local.z];
+                if (slot == block) continue;
+                if (journal != nullptr) journal->record(coord, local_index(local), slot, block);
+                slot = block;
+                world.invalidate(coord);
+            }
+            for (auto [pos, delay] : context.scheduled_) {
+                schedule(world, pos, delay);
+            }
+        }
+        stats_.active_chunks += chunks.size();
+    }
+    if (journal != nullptr) journal->end_batch();
+
+    stats_.skipped_chunks = world.chunk_count() - stats_.active_chunks;
+    stats_.ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void tick_scheduler::run(tick_context& context) const {
+    auto& ticks = *context.ticks_;
+    const auto origin = context.coord_ * chunk_size;
+
+    while (!ticks.queue.empty() && ticks.queue.top().tick <= tick_) {
+        const auto due = ticks.queue.top();
+        ticks.queue.pop();
+
+        const auto pos = origin + local_from_index(due.index);
+        const int block = context.get_block(pos);
+        if (block != due.block) continue;
+
+        if (const auto* handler = find_handler(scheduled_handlers_, block)) {
+            (*handler)(context, pos, block);
+            ++context.scheduled_count_;
+        }
+    }
+
+    if (ticks.random_blocks == 0) return;
+    for (int i = 0; i < random_ticks; ++i) {
+        const auto pos = origin + local_from_index(context.random() % chunk_volume);
+        const int block = context.get_block(pos);
+        if (const auto* handler = find_handler(random_handlers_, block)) {
+            (*handler)(context, pos, block);
+            ++context.random_count_;
+        }
+    }
+}
+
+void tick_scheduler::count_random_blocks(const world& world, thread_pool& pool) {
+    if (random_handlers_.empty()) return;
+
+    // chunks are never removed, so there are new ones exactly when the counts differ
+    if (chunks_.size() != world.chunk_count()) {
+        for (auto coord : world.chunks()) {
+            chunks_.try_emplace(coord);
+        }
+    }
+
+    stale_.clear();
+    for (auto& [coord, ticks] : chunks_) {
+        const auto revision = world.revision(coord);
+        if (ticks.revision == revision) continue;
+        stale_.push_back(stale_chunk{&ticks, world.find_chunk(coord), revision});
+    }
+
+    pool.parallel_for(stale_.size(), [&](std::size_t i) {
+        auto& [ticks, chunk, revision] = stale_[i];
+        ticks->random_blocks = static_cast<std::size_t>(std::ranges::count_if(chunk->blocks(), [&](int block) {
+            return find_handler(random_handlers_, block) != nullptr;
+        }));
+        ticks->revision = revision;
+    });
+}
+
+}
@@ -0,0 +1,100 @@
+#include <world/visibility.h>
+#include <chrono>
+#include <cmath>
+#include <utility>
+
+namespace ja {
+
+namespace {
+
+[[nodiscard]] float elapsed_ms(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+void visibility_graph::update(const world& world, thread_pool& pool) {
+    const auto start = std::chrono::steady_clock::now();
+
+    if (!tracker_) tracker_ = world.track_changes();
+    world.take_changes(*tracker_, changed_);
+
+    // chunks are never removed from a world, so the bounds only grow
+    std::vector<std::pair<face_connectivity*, const world_chunk*>> changed{};
+    for (auto coord : changed_) {
+        min_ = chunks_.empty() ? coord : glm::min(min_, coord);
+        max_ = chunks_.empty() ? coord : glm::max(max_, coord);
+        changed.emplace_back(&chunks_[coord], world.find_chunk(coord));
+    }
+
+    pool.parallel_for(changed.size(), [&changed](std::size_t index) {
+        auto [connectivity, chunk] = changed[index];
+        *connectivity = compute_connectivity(*chunk);
+    });
+
+    stats_.recomputed = changed.size();
+    stats_.update_ms = elapsed_ms(start);
+}
+
+void visibility_graph::visible_chunks(glm::vec3 position, glm::vec3 forward, std::vector<glm::ivec3>& chunks) {
+    const auto start = std::chrono::steady_clock::now();
+    chunks.clear();
+
+    if (chunks_.empty()) return;
+
+    const glm::ivec3 size = max_ - min_ + 1;
+    visited_.assign(static_cast<std::size_t>(size.x * size.y * size.z), 0);
+
+    auto visit = [&](glm::ivec3 chunk) {
+        if (glm::any(glm::lessThan(chunk, min_)) || glm::any(glm::greaterThan(chunk, max_))) return false;
+        const glm::ivec3 offset = chunk - min_;
+        auto& visited = visited_[(offset.x * size.y + offset.y) * size.z + offset.z];
+        return !std::exchange(visited, 1);
+    };
+
+    // a chunk can be partially in front of the camera while its center is not
+    const float radius = 0.5f * std::sqrt(3.0f) * chunk_size;
+
+    // cameras outside the world look in from the nearest chunk
+    const glm::ivec3 origin = glm::clamp(chunk_coord(block_coord(position)), min_, max_);
+
+    queue_.clear();
+    queue_.push_back(node{origin, -1, 0});
+    visit(origin);
+
+    for (std::size_t head = 0; head < queue_.size(); ++head) {
+        const node current = queue_[head];
+        if (chunks_.contains(current.chunk)) {
+            chunks.push_back(current.chunk);
+        }
+
+        const auto connectivity = this->connectivity(current.chunk);
+        for (auto face : cube_faces) {
+            const auto direction = 1u << static_cast<unsigned int>(face);
+            const auto back = 1u << static_cast<unsigned int>(opposite(face));
+
+            if (current.directions & back) continue;
+            if (current.entered >= 0 && !connectivity.connected(static_cast<cube_face>(current.entered), face)) continue;
+
+            const glm::ivec3 next = current.chunk + cube_face_normal(face);
+            if (glm::dot(chunk_bounds(next).center() - position, forward) < -radius) continue;
+            if (!visit(next)) continue;
+
+            queue_.push_back(node{
+                next,
+                static_cast<std::int8_t>(opposite(face)),
+                static_cast<std::uint8_t>(current.directions | direction),
+            });
+        }
+    }
+
+    stats_.visible = chunks.size();
+    stats_.search_ms = elapsed_ms(start);
+}
+
+face_connectivity visibility_graph::connectivity(glm::ivec3 chunk) const {
+    auto it = chunks_.find(chunk);
+    return (it != chunks_.end()) ? it->second : face_connectivity::all();
+}
+
+}
@@ -0,0 +1,208 @@
+#include <world/world.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <chrono>
+#include <world/chunk_codec.h>
+#include <world/edit_journal.h>
+
+namespace ja {
+
+int world::get_block(glm::ivec3 pos) const {
+    const auto* chunk = find_chunk(chunk_coord(pos));
+    if (chunk == nullptr) return blocks::empty;
+
+    const auto local = local_coord(pos);
+    return (*chunk)[local.x, local.y, local.z];
+}
+
+void world::set_block(glm::ivec3 pos, int block) {
+    const auto coord = chunk_coord(pos);
+    const auto local = local_coord(pos);
+    auto& slot = chunk_at(coord)[local.x, local.y, local.z];
+    if (journal_ != nullptr && slot != block) {
+        journal_->record(coord, local_index(local), slot, block);
+    }
+    slot = block;
+    invalidate(coord);
+}
+
+world_chunk* world::find_chunk(glm::ivec3 chunk) {
+    auto it = chunks_.find(chunk);
+    return (it != chunks_.end()) ? &writable(it->second) : nullptr;
+}
+
+const world_chunk* world::find_chunk(glm::ivec3 chunk) const {
+    auto it = chunks_.find(chunk);
+    return (it != chunks_.end()) ? &load(it->second).blocks : nullptr;
+}
+
+world_chunk& world::chunk_at(glm::ivec3 chunk) {
+    auto& entry = chunks_[chunk];
+    if (entry.revision == 0) {
+        entry.chunk = std::make_shared<shared_chunk>();
+        entry.revision = 1;
+        entry.resident.store(true, std::memory_order_release);
+        report(chunk, entry);
+    }
+    return writable(entry);
+}
+
+chunk_snapshot world::snapshot(glm::ivec3 chunk) const {
+    auto it = chunks_.find(chunk);
+    if (it == chunks_.end()) return {};
+
+    load(it->second);
+    return {it->second.chunk, it->second.revision};
+}
+
+void world::invalidate(glm::ivec3 chunk) {
+    if (auto it = chunks_.find(chunk); it != chunks_.end()) {
+        ++it->second.revision;
+        report(chunk, it->second);
+    }
+}
+
+std::uint64_t world::revision(glm::ivec3 chunk) const {
+    auto it = chunks_.find(chunk);
+    return (it != chunks_.end()) ? it->second.revision : 0;
+}
+
+bool world::compressed(glm::ivec3 chunk) const {
+    auto it = chunks_.find(chunk);
+    return it != chunks_.end() && !it->second.resident.load(std::memory_order_acquire);
+}
+
+std::size_t world::compressed_bytes(glm::ivec3 chunk) const {
+    auto it = chunks_.find(chunk);
+    return (it != chunks_.end()) ? it->second.compressed.size() : 0;
+}
+
+bool world::take_accessed(glm::ivec3 chunk) {
+    auto it = chunks_.find(chunk);
+    return it != chunks_.end() && it->second.accessed.exchange(false, std::memory_order_relaxed);
+}
+
+bool world::store_compressed(glm::ivec3 chunk, std::uint64_t revision, std::vector<std::uint8_t> data) {
+    auto it = chunks_.find(chunk);
+    if (it == chunks_.end() || it->second.revision != revision) return false;
+
+    it->second.compressed = std::move(data);
+    it->second.compressed_revision = revision;
+    return release(chunk);
+}
+
+bool world::release(glm::ivec3 chunk) {
+    auto it = chunks_.find(chunk);
+    if (it == chunks_.end()) return false;
+
+    auto& entry = it->second;
+    if (!entry.resident.load(std::memory_order_relaxed)) return false;
+    if (entry.compressed.empty() || entry.compressed_revision != entry.revision) return false;
+
+    // snapshots keep their own reference to the blocks
+    entry.resident.store(false, std::memory_order_relaxed);
+    entry.chunk.reset();
+    return true;
+}
+
+std::size_t world::track_changes() const {
+    std::lock_guard lock{changes_mutex_};
+    assert(changes_.size() < max_trackers);
+    const auto tracker = changes_.size();
+    const auto bit = std::uint32_t{1} << tracker;
+
+    auto& changes = changes_.emplace_back();
+    for (const auto& [coord, entry] : chunks_) {
+        entry.reported.fetch_or(bit, std::memory_order_relaxed);
+        changes.push_back(coord);
+    }
+    trackers_.fetch_or(bit, std::memory_order_relaxed);
+    return tracker;
+}
+
+void world::take_changes(std::size_t tracker, std::vector<glm::ivec3>& chunks) const {
+    chunks.clear();
+    {
+        std::lock_guard lock{changes_mutex_};
+        std::swap(chunks, changes_[tracker]);
+    }
+
+    const auto mask = ~(std::uint32_t{1} << tracker);
+    for (auto coord : chunks) {
+        chunks_.find(coord)->second.reported.fetch_and(mask, std::memory_order_relaxed);
+    }
+}
+
+void world::report(glm::ivec3 chunk, const entry& entry) const {
+    // chunks are usually changed many times in a row, and only the first time counts
+    const auto trackers = trackers_.load(std::memory_order_relaxed);
+    if ((entry.reported.load(std::memory_order_relaxed) & trackers) == trackers) return;
+
+    auto pending = trackers & ~entry.reported.fetch_or(trackers, std::memory_order_relaxed);
+    if (pending == 0) return;
+
+    std::lock_guard lock{changes_mutex_};
+    for (; pending != 0; pending &= pending - 1) {
+        changes_[static_cast<std::size_t>(std::countr_zero(pending))].push_back(chunk);
+    }
+}
+
+decompression_stats world::decompression() const {
+    std::lock_guard lock{decompress_mutex_};
+    return decompression_;
+}
+
+shared_chunk& world::load(const entry& entry) const {
+    if (!entry.accessed.load(std::memory_order_relaxed)) {
+        entry.accessed.store(true, std::memory_order_relaxed);
+    }
+
+    if (entry.resident.load(std::memory_order_acquire)) return *entry.chunk;
+
+    std::lock_guard lock{decompress_mutex_};
+    if (entry.resident.load(std::memory_order_relaxed) || entry.corrupt) return *entry.chunk;
+
+    const auto start = std::chrono::steady_clock::now();
+    auto chunk = std::make_shared<shared_chunk>();
+    const bool valid = decompress_blocks(entry.compressed, chunk->blocks.blocks());
+    entry.chunk = std::move(chunk);
+    if (!valid) {
+        entry.corrupt = true;
+        ++decompression_.failures;
+        return *entry.chunk;
+    }
+    entry.resident.store(true, std::memory_order_release);
+
+    const auto ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    ++decompression_.count;
+    decompression_.total_ms += ms;
+    decompression_.max_ms = std::max(decompression_.max_ms, ms);
+
+    return *entry.chunk;
+}
+
+world_chunk& world::writable(entry& entry) {
+    load(entry);
+
+    // once written to, what could be decoded of a corrupt chunk becomes its blocks
+    if (!entry.resident.load(std::memory_order_acquire)) {
+        std::lock_guard lock{decompress_mutex_};
+        entry.corrupt = false;
+        entry.resident.store(true, std::memory_order_release);
+    }
+
+    // snapshots are only taken on this thread, so the count can't go up in the meantime
+    if (entry.chunk->readers.load(std::memory_order_acquire) > 0) {
+        entry.chunk = std::make_shared<shared_chunk>(entry.chunk->blocks);
+        copies_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // the compressed form is outdated as soon as the blocks are written to
+    entry.compressed = {};
+    return entry.chunk->blocks;
+}
+
+}
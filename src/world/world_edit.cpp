@@ -0,0 +1,310 @@
+#include <world/world_edit.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <span>
+#include <utility>
+#include <world/chunk_codec.h>
+#include <world/edit_journal.h>
+
+namespace ja {
+
+namespace {
+
+constexpr std::array<char, 4> magic{'J', 'A', 'S', 'C'};
+constexpr std::uint32_t version{1};
+
+static_assert(std::endian::native == std::endian::little, "schematics are stored in little-endian byte order");
+
+/**
+ * The part of a region that lies within a chunk.
+ */
+struct chunk_region {
+    glm::ivec3 coord{};
+
+    /**
+     * The chunk to write to, only looked up once a row actually changes.
+     */
+    world_chunk* chunk{};
+
+    /**
+     * First and last block, local to the chunk.
+     */
+    glm::ivec3 min{};
+    glm::ivec3 max{};
+
+    edit_batch batch{};
+    std::size_t changed{};
+};
+
+/**
+ * Split a region by chunk, skipping missing chunks unless they are to be created.
+ *
+ * Only created chunks come with a pointer. Looking up the others for
+ * writing right away would copy the ones held by a snapshot and drop the
+ * compressed form of all of them, even if none of their blocks change.
+ */
+[[nodiscard]] std::vector<chunk_region> split_region(world& world, glm::ivec3 min, glm::ivec3 max, bool create) {
+    std::vector<chunk_region> regions{};
+    const glm::ivec3 min_chunk = chunk_coord(min);
+    const glm::ivec3 max_chunk = chunk_coord(max);
+
+    // chunks are created up front, as creating them isn't thread-safe
+    for (int x = min_chunk.x; x <= max_chunk.x; ++x) {
+        for (int y = min_chunk.y; y <= max_chunk.y; ++y) {
+            for (int z = min_chunk.z; z <= max_chunk.z; ++z) {
+                const glm::ivec3 coord{x, y, z};
+                world_chunk* chunk{};
+                if (world.revision(coord) == 0) {
+                    if (!create) continue;
+                    chunk = &world.chunk_at(coord);
+                }
+
+                const glm::ivec3 origin = coord * chunk_size;
+                regions.push_back({
+                    .coord = coord,
+                    .chunk = chunk,
+                    .min = glm::max(min - origin, glm::ivec3{0}),
+                    .max = glm::min(max - origin, glm::ivec3{chunk_size - 1}),
+                });
+            }
+        }
+    }
+
+    return regions;
+}
+
+/**
+ * Edit a region one row of blocks along the z axis at a time.
+ *
+ * @param edit_row Invoked with the world coordinates of the first block of
+ *                 a row and the blocks of the row, which it may change.
+ */
+template<typename F>
+edit_stats edit_rows(world& world, thread_pool& pool, glm::ivec3 min, glm::ivec3 max, bool create, F&& edit_row) {
+    const auto start = std::chrono::steady_clock::now();
+    if (glm::any(glm::greaterThan(min, max))) return {};
+
+    auto regions = split_region(world, min, max, create);
+    auto* journal = world.journal();
+
+    // rows are edited in a copy, and the chunk is only taken for writing by
+    // the first row that changes, which is fine from any thread for distinct chunks
+    pool.parallel_for(regions.size(), [&](std::size_t index) {
+        auto& region = regions[index];
+        const world_chunk* source = region.chunk;
+        if (source == nullptr) source = std::as_const(world).find_chunk(region.coord);
+        const glm::ivec3 origin = region.coord * chunk_size;
+        const auto length = static_cast<std::size_t>(region.max.z - region.min.z + 1);
+
+        // the source may be a shared chunk, whose blocks go away with its last
+        // snapshot once this region copies it, so rows are compared against a copy
+        std::array<int, chunk_size> original{};
+        std::array<int, chunk_size> buffer{};
+        const std::span<const int> before{original.data(), length};
+        const std::span<int> row{buffer.data(), length};
+        for (int i = region.min.x; i <= region.max.x; ++i) {
+            for (int j = region.min.y; j <= region.max.y; ++j) {
+                std::ranges::copy(std::span<const int>{&(*source)[i, j, region.min.z], length}, original.begin());
+                std::ranges::copy(before, row.begin());
+
+                edit_row(origin + glm::ivec3{i, j, region.min.z}, row);
+                if (std::ranges::equal(row, before)) continue;
+
+                if (region.chunk == nullptr) region.chunk = world.find_chunk(region.coord);
+                for (std::size_t k = 0; k < length; ++k) {
+                    if (row[k] == before[k]) continue;
+                    ++region.changed;
+                    if (journal != nullptr) {
+                        const auto local = glm::ivec3{i, j, region.min.z + static_cast<int>(k)};
+                        region.batch.add(region.coord, local_index(local), before[k], row[k]);
+                    }
+                }
+
+                std::ranges::copy(row, &(*region.chunk)[i, j, region.min.z]);
+                source = region.chunk;
+            }
+        }
+    });
+
+    edit_stats stats{};
+    if (journal != nullptr) journal->begin_batch();
+    for (const auto& region : regions) {
+        if (region.changed == 0) continue;
+
+        world.invalidate(region.coord);
+        if (journal != nullptr) journal->commit(region.batch);
+        ++stats.chunks;
+        stats.blocks += region.changed;
+    }
+    if (journal != nullptr) journal->end_batch();
+
+    stats.ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+}
+
+clipboard clipboard::rotated(int quarter_turns) const {
+    quarter_turns = ((quarter_turns % 4) + 4) % 4;
+    if (quarter_turns == 0) return *this;
+
+    const glm::ivec3 rotated_size = (quarter_turns == 2) ? size : glm::ivec3{size.z, size.y, size.x};
+    clipboard result{rotated_size, std::vector<int>(blocks.size(), blocks::empty)};
+
+    for (int x = 0; x < size.x; ++x) {
+        for (int y = 0; y < size.y; ++y) {
+            for (int z = 0; z < size.z; ++z) {
+                glm::ivec3 to{};
+                switch (quarter_turns) {
+                    case 1:
+                        to = {z, y, size.x - 1 - x};
+                        break;
+                    case 2:
+                        to = {size.x - 1 - x, y, size.z - 1 - z};
+                        break;
+                    default:
+                        to = {size.z - 1 - z, y, x};
+                        break;
+                }
+                result.blocks[static_cast<std::size_t>((to.x * rotated_size.y + to.y) * rotated_size.z + to.z)] = (*this)[x, y, z];
+            }
+        }
+    }
+
+    return result;
+}
+
+edit_stats fill_box(world& world, thread_pool& pool, glm::ivec3 min, glm::ivec3 max, int block) {
+    return edit_rows(world, pool, min, max, !is_empty(block), [block](glm::ivec3, std::span<int> row) {
+        std::ranges::fill(row, block);
+    });
+}
+
+edit_stats fill_sphere(world& world, thread_pool& pool, glm::ivec3 center, float radius, int block) {
+    const glm::ivec3 extent{static_cast<int>(std::floor(radius))};
+
+    return edit_rows(world, pool, center - extent, center + extent, !is_empty(block), [=](glm::ivec3 start, std::span<int> row) {
+        const glm::vec2 offset{start.x - center.x, start.y - center.y};
+        const float remaining = radius * radius - glm::dot(offset, offset);
+        if (remaining < 0.0f) return;
+
+        // the blocks of the row within the sphere
+        const int half = static_cast<int>(std::floor(std::sqrt(remaining)));
+        const int first = std::max(center.z - half - start.z, 0);
+        const int last = std::min(center.z + half - start.z, static_cast<int>(row.size()) - 1);
+        if (first > last) return;
+
+        std::ranges::fill(row.subspan(static_cast<std::size_t>(first), static_cast<std::size_t>(last - first + 1)), block);
+    });
+}
+
+edit_stats replace_blocks(world& world, thread_pool& pool, glm::ivec3 min, glm::ivec3 max, int from, int to) {
+    // empty blocks of missing chunks aren't replaced
+    return edit_rows(world, pool, min, max, false, [from, to](glm::ivec3, std::span<int> row) {
+        std::ranges::replace(row, from, to);
+    });
+}
+
+clipboard copy_region(const world& world, thread_pool& pool, glm::ivec3 min, glm::ivec3 max) {
+    if (glm::any(glm::greaterThan(min, max))) return {};
+
+    const glm::ivec3 size = max - min + 1;
+    clipboard result{size, std::vector<int>(static_cast<std::size_t>(size.x * size.y * size.z), blocks::empty)};
+
+    std::vector<glm::ivec3> coords{};
+    const glm::ivec3 min_chunk = chunk_coord(min);
+    const glm::ivec3 max_chunk = chunk_coord(max);
+    for (int x = min_chunk.x; x <= max_chunk.x; ++x) {
+        for (int y = min_chunk.y; y <= max_chunk.y; ++y) {
+            for (int z = min_chunk.z; z <= max_chunk.z; ++z) {
+                coords.emplace_back(x, y, z);
+            }
+        }
+    }
+
+    pool.parallel_for(coords.size(), [&](std::size_t index) {
+        const auto coord = coords[index];
+        const auto* chunk = world.find_chunk(coord);
+        if (chunk == nullptr) return;
+
+        const glm::ivec3 origin = coord * chunk_size;
+        const glm::ivec3 first = glm::max(min - origin, glm::ivec3{0});
+        const glm::ivec3 last = glm::min(max - origin, glm::ivec3{chunk_size - 1});
+        const auto length = static_cast<std::size_t>(last.z - first.z + 1);
+
+        for (int i = first.x; i <= last.x; ++i) {
+            for (int j = first.y; j <= last.y; ++j) {
+                const glm::ivec3 to = origin + glm::ivec3{i, j, first.z} - min;
+                const std::span<const int> row{&(*chunk)[i, j, first.z], length};
+                std::ranges::copy(row, result.blocks.begin() + (to.x * size.y + to.y) * size.z + to.z);
+            }
+        }
+    });
+
+    return result;
+}
+
+edit_stats paste(world& world, thread_pool& pool, const clipboard& clipboard, glm::ivec3 origin, bool include_empty) {
+    return edit_rows(world, pool, origin, origin + clipboard.size - 1, true, [&clipboard, origin, include_empty](glm::ivec3 start, std::span<int> row) {
+        const glm::ivec3 from = start - origin;
+        const auto offset = (from.x * clipboard.size.y + from.y) * clipboard.size.z + from.z;
+        const std::span<const int> source{clipboard.blocks.data() + offset, row.size()};
+
+        if (include_empty) {
+            std::ranges::copy(source, row.begin());
+            return;
+        }
+
+        for (std::size_t k = 0; k < row.size(); ++k) {
+            if (!is_empty(source[k])) row[k] = source[k];
+        }
+    });
+}
+
+bool save_schematic(const std::string& path, const clipboard& clipboard) {
+    std::ofstream ofs{path, std::ios::binary};
+    if (!ofs) return false;
+
+    ofs.write(magic.data(), magic.size());
+    for (auto value : {version, static_cast<std::uint32_t>(clipboard.size.x), static_cast<std::uint32_t>(clipboard.size.y), static_cast<std::uint32_t>(clipboard.size.z)}) {
+        const auto bytes = std::bit_cast<std::array<char, sizeof(value)>>(value);
+        ofs.write(bytes.data(), bytes.size());
+    }
+
+    const auto data = compress_blocks(clipboard.blocks);
+    ofs.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(ofs);
+}
+
+std::optional<clipboard> load_schematic(const std::string& path) {
+    std::ifstream ifs{path, std::ios::binary};
+    if (!ifs) return std::nullopt;
+
+    const std::vector<std::uint8_t> data{std::istreambuf_iterator<char>{ifs}, std::istreambuf_iterator<char>{}};
+    constexpr std::size_t header_size{magic.size() + 4 * sizeof(std::uint32_t)};
+    if (data.size() < header_size) return std::nullopt;
+    if (!std::equal(magic.begin(), magic.end(), data.begin())) return std::nullopt;
+
+    std::array<std::uint32_t, 4> header{};
+    std::memcpy(header.data(), data.data() + magic.size(), sizeof(header));
+    const auto [file_version, x, y, z] = header;
+    if (file_version != version) return std::nullopt;
+
+    // guard against sizes that don't fit in memory
+    constexpr std::uint64_t max_volume{1u << 28};
+    if (static_cast<std::uint64_t>(x) * y * z > max_volume) return std::nullopt;
+
+    clipboard result{glm::ivec3{x, y, z}, std::vector<int>(static_cast<std::size_t>(x) * y * z)};
+    if (!decompress_blocks(std::span{data}.subspan(header_size), result.blocks)) return std::nullopt;
+    return result;
+}
+
+}